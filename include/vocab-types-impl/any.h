@@ -49,6 +49,7 @@ class any
     {
         T value;
         holder(T value) : value{std::move(value)} {}
+        template<class F> holder(in_place_from_t, F && f) : value(std::forward<F>(f)()) {}
         std::unique_ptr<holder_base> clone() { return std::unique_ptr<holder_base>(new holder(value)); }
         const type_info& type() { return typeid(T); }
         void * get() { return &value; }
@@ -68,6 +69,7 @@ public:
     template<class ValueType> any(ValueType&& value) : _Value{new holder<std::decay_t<ValueType>>{std::forward<ValueType>(value)}} {}
     template<class T, class... Args> explicit any(in_place_type_t<T>, Args&&... args) { emplace<T>(std::forward<Args>(args)...); } // (5)
     template<class T, class U, class... Args> explicit any(in_place_type_t<T>, initializer_list<U> il, Args&&... args) { emplace<T>(il, std::forward<Args>(args)...); } // (6)
+    template<class F> explicit any(in_place_from_t, F && f) { emplace_from(std::forward<F>(f)); } // (extension)
 
     ////////////////////////////////////////////////////////////////////////
     // (destructor) - http://en.cppreference.com/w/cpp/utility/any/%7Eany //
@@ -90,6 +92,9 @@ public:
     template<class T, class... Args> void emplace( Args&&... args ) { _Value = std::unique_ptr<holder_base>{new holder<T>{std::forward<Args>(args)...}}; } // (1)
     template<class T, class U, class... Args> void emplace( std::initializer_list<U> il, Args&&... args ) { _Value = std::unique_ptr<holder_base>{new holder<T>{il, std::forward<Args>(args)...}}; } // (2)
 
+    // Construct a value of the type returned by f() directly from its result, then replace the current value with it
+    template<class F, class T = std::decay_t<decltype(std::declval<F>()())>> T & emplace_from(F && f) { auto h = new holder<T>(in_place_from, std::forward<F>(f)); _Value = std::unique_ptr<holder_base>{h}; return h->value; } // (extension)
+
     ////////////////////////////////////////////////////////////////
     // reset - http://en.cppreference.com/w/cpp/utility/any/reset //
     ////////////////////////////////////////////////////////////////
@@ -0,0 +1,300 @@
+// atomic_variant.h provides atomic_variant and atomic_optional, which allow
+// variants and optionals of trivially copyable types to be published between
+// threads without a mutex. It is an extension to vocab-types, and its
+// permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_ATOMIC_VARIANT
+#define VOCAB_TYPES_ATOMIC_VARIANT
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include "optional.h"
+#include "variant.h"
+
+namespace vocab {
+
+namespace detail {
+
+template<class... Types> struct max_sizeof;
+template<> struct max_sizeof<> { constexpr static size_t value = 0; };
+template<class First, class... Rest> struct max_sizeof<First, Rest...> { constexpr static size_t value = sizeof(First) > max_sizeof<Rest...>::value ? sizeof(First) : max_sizeof<Rest...>::value; };
+
+template<class... Types> struct all_trivially_copyable;
+template<> struct all_trivially_copyable<> : std::true_type {};
+template<class First, class... Rest> struct all_trivially_copyable<First, Rest...> : std::integral_constant<bool, std::is_trivially_copyable<First>::value && all_trivially_copyable<Rest...>::value> {};
+
+template<size_t N> struct byte_string { unsigned char data[N]; };
+template<size_t N> bool operator == (const byte_string<N> & a, const byte_string<N> & b) { return std::memcmp(a.data, b.data, N) == 0; }
+
+// Stores N bytes which can be loaded, stored, and compared-and-exchanged atomically. Byte strings
+// which fit in a machine word are kept in a std::atomic<uint64_t>, byte strings which fit in two
+// machine words use a double-width CAS where the target supports one, and everything else is
+// guarded by a sequence lock, under which readers never block writers.
+template<size_t N, class Enable = void> class atomic_bytes
+{
+    constexpr static size_t word_count = (N + 7) / 8;
+    std::atomic<unsigned> _Sequence {0};
+    std::atomic<uint64_t> _Words[word_count];
+
+    unsigned _Lock()
+    {
+        for(unsigned seq = _Sequence.load(std::memory_order_relaxed); ; seq = _Sequence.load(std::memory_order_relaxed))
+        {
+            if(seq % 2 == 0 && _Sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                std::atomic_thread_fence(std::memory_order_release);
+                return seq;
+            }
+            std::this_thread::yield();
+        }
+    }
+    void _Unlock(unsigned seq) { _Sequence.store(seq + 2, std::memory_order_release); }
+    byte_string<N> _Read() const
+    {
+        uint64_t words[word_count];
+        for(size_t i=0; i<word_count; ++i) words[i] = _Words[i].load(std::memory_order_relaxed);
+        byte_string<N> b;
+        std::memcpy(b.data, words, N);
+        return b;
+    }
+    void _Write(const byte_string<N> & b)
+    {
+        uint64_t words[word_count] {};
+        std::memcpy(words, b.data, N);
+        for(size_t i=0; i<word_count; ++i) _Words[i].store(words[i], std::memory_order_relaxed);
+    }
+public:
+    explicit atomic_bytes(const byte_string<N> & init) { _Write(init); }
+
+    static constexpr bool is_lock_free() { return false; }
+
+    byte_string<N> load() const
+    {
+        for(;;)
+        {
+            const unsigned seq = _Sequence.load(std::memory_order_acquire);
+            if(seq % 2 == 0)
+            {
+                const byte_string<N> b = _Read();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(_Sequence.load(std::memory_order_relaxed) == seq) return b;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void store(const byte_string<N> & desired)
+    {
+        const unsigned seq = _Lock();
+        _Write(desired);
+        _Unlock(seq);
+    }
+
+    bool compare_exchange(byte_string<N> & expected, const byte_string<N> & desired)
+    {
+        const unsigned seq = _Lock();
+        const byte_string<N> current = _Read();
+        const bool equal = current == expected;
+        if(equal) _Write(desired);
+        else expected = current;
+        _Unlock(seq);
+        return equal;
+    }
+};
+
+template<size_t N> class atomic_bytes<N, std::enable_if_t<(N <= 8)>>
+{
+    std::atomic<uint64_t> _Word;
+
+    static uint64_t _Pack(const byte_string<N> & b) { uint64_t word = 0; std::memcpy(&word, b.data, N); return word; }
+    static byte_string<N> _Unpack(uint64_t word) { byte_string<N> b; std::memcpy(b.data, &word, N); return b; }
+public:
+    explicit atomic_bytes(const byte_string<N> & init) : _Word{_Pack(init)} {}
+
+    static constexpr bool is_lock_free() { return true; }
+
+    byte_string<N> load() const { return _Unpack(_Word.load(std::memory_order_acquire)); }
+    void store(const byte_string<N> & desired) { _Word.store(_Pack(desired), std::memory_order_release); }
+    bool compare_exchange(byte_string<N> & expected, const byte_string<N> & desired)
+    {
+        uint64_t word = _Pack(expected);
+        const bool equal = _Word.compare_exchange_strong(word, _Pack(desired), std::memory_order_acq_rel, std::memory_order_acquire);
+        expected = _Unpack(word);
+        return equal;
+    }
+};
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+// GCC routes std::atomic of 16-byte types through libatomic, so when the target guarantees
+// cmpxchg16b (e.g. -mcx16) we invoke the builtin directly. Loads are performed as a CAS which
+// never changes the stored value.
+template<size_t N> class atomic_bytes<N, std::enable_if_t<(N > 8 && N <= 16)>>
+{
+    typedef unsigned __int128 word_t;
+    alignas(16) mutable word_t _Word;
+
+    static word_t _Pack(const byte_string<N> & b) { word_t word = 0; std::memcpy(&word, b.data, N); return word; }
+    static byte_string<N> _Unpack(word_t word) { byte_string<N> b; std::memcpy(b.data, &word, N); return b; }
+public:
+    explicit atomic_bytes(const byte_string<N> & init) : _Word{_Pack(init)} {}
+
+    static constexpr bool is_lock_free() { return true; }
+
+    byte_string<N> load() const { return _Unpack(__sync_val_compare_and_swap(&_Word, word_t{0}, word_t{0})); }
+    void store(const byte_string<N> & desired)
+    {
+        const word_t word = _Pack(desired);
+        for(word_t expected = 0, prior; (prior = __sync_val_compare_and_swap(&_Word, expected, word)) != expected; ) expected = prior;
+    }
+    bool compare_exchange(byte_string<N> & expected, const byte_string<N> & desired)
+    {
+        const word_t word = _Pack(expected), prior = __sync_val_compare_and_swap(&_Word, word, _Pack(desired));
+        expected = _Unpack(prior);
+        return prior == word;
+    }
+};
+#endif
+
+// Converts between a variant of trivially copyable types and a byte string consisting of a one byte
+// tag followed by the bytes of the active alternative. Unused bytes (including the storage of empty
+// types) are always zero, so that two equal variants produce identical byte strings, provided their
+// alternatives contain no padding.
+template<class... Types> struct variant_bytes
+{
+    typedef std::variant<Types...> variant_type;
+    typedef byte_string<1 + max_sizeof<Types...>::value> bytes_type;
+
+    static bytes_type pack(const variant_type & v)
+    {
+        assert(!v.valueless_by_exception());
+        bytes_type b {};
+        b.data[0] = static_cast<unsigned char>(v.index());
+        std::visit([&b](const auto & x) { if(!std::is_empty<std::decay_t<decltype(x)>>::value) std::memcpy(b.data + 1, &x, sizeof(x)); }, v);
+        return b;
+    }
+
+    template<size_t I> static variant_type unpack_alternative(const unsigned char * in)
+    {
+        typedef std::variant_alternative_t<I, variant_type> T;
+        std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+        std::memcpy(&storage, in, sizeof(T));
+        return variant_type{std::in_place<I>, reinterpret_cast<const T &>(storage)};
+    }
+    template<size_t... I> static variant_type unpack(const bytes_type & b, std::index_sequence<I...>)
+    {
+        static variant_type (* const table[])(const unsigned char *) = {&unpack_alternative<I>...};
+        return table[b.data[0]](b.data + 1);
+    }
+    static variant_type unpack(const bytes_type & b) { return unpack(b, std::index_sequence_for<Types...>{}); }
+};
+
+} // namespace vocab::detail
+
+/////////////////////////////////////////////////////////////////////////////////
+// atomic_variant - atomic publication of variants of trivially copyable types //
+/////////////////////////////////////////////////////////////////////////////////
+
+template<class... Types> class atomic_variant
+{
+    static_assert(detail::all_trivially_copyable<Types...>::value, "atomic_variant requires trivially copyable alternatives");
+    static_assert(sizeof...(Types) <= 256, "atomic_variant supports at most 256 alternatives");
+
+    typedef detail::variant_bytes<Types...> bytes;
+    detail::atomic_bytes<sizeof(typename bytes::bytes_type)> _Bytes;
+public:
+    typedef std::variant<Types...> value_type;
+
+    atomic_variant() : atomic_variant(value_type{}) {}
+    atomic_variant(const value_type & desired) : _Bytes{bytes::pack(desired)} {}
+    atomic_variant(const atomic_variant &) = delete;
+    atomic_variant & operator = (const atomic_variant &) = delete;
+
+    static constexpr bool is_lock_free() { return decltype(_Bytes)::is_lock_free(); }
+
+    value_type load() const { return bytes::unpack(_Bytes.load()); }
+    void store(const value_type & desired) { _Bytes.store(bytes::pack(desired)); }
+
+    // Compares the stored variant with expected bytewise, replacing it with desired if they are identical,
+    // and otherwise loading the stored variant into expected
+    bool compare_exchange(value_type & expected, const value_type & desired)
+    {
+        auto b = bytes::pack(expected);
+        if(_Bytes.compare_exchange(b, bytes::pack(desired))) return true;
+        expected = bytes::unpack(b);
+        return false;
+    }
+
+    // Invokes vis on the active alternative of a consistent snapshot of the stored variant
+    template<class Visitor> auto visit_snapshot(Visitor && vis) const { const value_type snapshot = load(); return std::visit(std::forward<Visitor>(vis), snapshot); }
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+// atomic_optional - atomic publication of optionals of trivially copyable types //
+///////////////////////////////////////////////////////////////////////////////////
+
+template<class T> class atomic_optional
+{
+    static_assert(std::is_trivially_copyable<T>::value, "atomic_optional requires a trivially copyable value type");
+
+    typedef detail::variant_bytes<std::monostate, T> bytes;
+    detail::atomic_bytes<sizeof(typename bytes::bytes_type)> _Bytes;
+
+    static typename bytes::bytes_type _Pack(const std::optional<T> & o) { return bytes::pack(o ? typename bytes::variant_type{*o} : typename bytes::variant_type{}); }
+    static std::optional<T> _Unpack(const typename bytes::bytes_type & b) { const auto v = bytes::unpack(b); return v.index() ? std::optional<T>{std::get<1>(v)} : std::nullopt; }
+public:
+    typedef std::optional<T> value_type;
+
+    atomic_optional() : atomic_optional(std::nullopt) {}
+    atomic_optional(const value_type & desired) : _Bytes{_Pack(desired)} {}
+    atomic_optional(const atomic_optional &) = delete;
+    atomic_optional & operator = (const atomic_optional &) = delete;
+
+    static constexpr bool is_lock_free() { return decltype(_Bytes)::is_lock_free(); }
+
+    value_type load() const { return _Unpack(_Bytes.load()); }
+    void store(const value_type & desired) { _Bytes.store(_Pack(desired)); }
+
+    // Compares the stored optional with expected bytewise, replacing it with desired if they are identical,
+    // and otherwise loading the stored optional into expected
+    bool compare_exchange(value_type & expected, const value_type & desired)
+    {
+        auto b = _Pack(expected);
+        if(_Bytes.compare_exchange(b, _Pack(desired))) return true;
+        expected = _Unpack(b);
+        return false;
+    }
+
+    // Invokes f on a consistent snapshot of the stored optional
+    template<class F> auto visit_snapshot(F && f) const { const value_type snapshot = load(); return std::forward<F>(f)(snapshot); }
+};
+
+} // namespace vocab
+
+#endif
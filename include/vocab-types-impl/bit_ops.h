@@ -0,0 +1,74 @@
+// bit_ops.h provides the bit counting helpers shared by the bitmap based
+// extensions of vocab-types. It is an implementation detail of those headers,
+// and its permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_BIT_OPS
+#define VOCAB_TYPES_BIT_OPS
+
+#include <cstdint>
+
+namespace vocab {
+namespace detail {
+
+// The number of set bits in x, which compiles to a single popcnt instruction where the target has one
+inline int popcount64(uint64_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555);
+    x = (x & 0x3333333333333333) + ((x >> 2) & 0x3333333333333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0F;
+    return static_cast<int>((x * 0x0101010101010101) >> 56);
+#endif
+}
+
+// The position of the lowest set bit of x, which must not be zero
+inline int countr_zero64(uint64_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    return popcount64((x & (0 - x)) - 1);
+#endif
+}
+
+// A mask of the low n bits, for 0 <= n <= 64
+inline uint64_t low_bits64(unsigned n) noexcept { return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1; }
+
+// The position of the set bit of x which has k set bits below it, where k must be less than popcount64(x)
+inline int select64(uint64_t x, unsigned k) noexcept
+{
+    for(; k; --k) x &= x - 1;
+    return countr_zero64(x);
+}
+
+} // namespace vocab::detail
+} // namespace vocab
+
+#endif
@@ -0,0 +1,175 @@
+// compact_optional.h provides compact_optional, an optional which marks the
+// absence of a value with a reserved sentinel value of T rather than with a
+// separate flag, so that it is exactly the size of T. It is an extension to
+// vocab-types, and its permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_COMPACT_OPTIONAL
+#define VOCAB_TYPES_COMPACT_OPTIONAL
+
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "optional.h"
+
+namespace vocab {
+
+// A sentinel policy for compact_optional provides empty_value(), the value which represents an empty optional, and
+// is_empty(x), which tests for it. sentinel_value reserves a single constant, such as -1 for an index, nullptr for a
+// pointer, or a reserved enumerator, and nan_sentinel reserves NaN, which is tested for with x != x, as it never
+// compares equal to itself.
+template<class T, T Value> struct sentinel_value
+{
+    static constexpr T empty_value() noexcept { return Value; }
+    static constexpr bool is_empty(const T & x) noexcept { return x == Value; }
+};
+
+template<class T> struct nan_sentinel
+{
+    static_assert(std::numeric_limits<T>::has_quiet_NaN, "nan_sentinel requires a floating point type with a quiet NaN");
+    static constexpr T empty_value() noexcept { return std::numeric_limits<T>::quiet_NaN(); }
+    static constexpr bool is_empty(const T & x) noexcept { return x != x; }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////
+// compact_optional - optional which is empty when its value is a reserved sentinel //
+//////////////////////////////////////////////////////////////////////////////////////
+
+// compact_optional<T, Sentinel> has the interface of std::optional<T>, but stores only a T, so that columns of
+// optional indices or measurements are no larger than columns of the values themselves, and it is trivially copyable
+// whenever T is. The sentinel value itself can therefore never be held as a value; storing it leaves the optional
+// empty, which is checked by an assertion. Comparisons and hashes agree with those of std::optional<T>, and it
+// converts to and from std::optional<T>.
+template<class T, class Sentinel> class compact_optional
+{
+    T _Value;
+public:
+    typedef T value_type;
+    typedef Sentinel sentinel_type;
+
+    constexpr compact_optional() noexcept : _Value(Sentinel::empty_value()) {}
+    constexpr compact_optional(std::nullopt_t) noexcept : _Value(Sentinel::empty_value()) {}
+    compact_optional(const T & value) : _Value(value) { assert(!Sentinel::is_empty(_Value)); }
+    compact_optional(T && value) : _Value(std::move(value)) { assert(!Sentinel::is_empty(_Value)); }
+    compact_optional(const std::optional<T> & value) : _Value(value ? *value : Sentinel::empty_value()) { assert(!value || !Sentinel::is_empty(_Value)); }
+
+    compact_optional & operator=(std::nullopt_t) noexcept { _Value = Sentinel::empty_value(); return *this; }
+    compact_optional & operator=(const T & value) { assert(!Sentinel::is_empty(value)); _Value = value; return *this; }
+    compact_optional & operator=(T && value) { assert(!Sentinel::is_empty(value)); _Value = std::move(value); return *this; }
+
+    template<class... Args> T & emplace(Args &&... args) { _Value = T(std::forward<Args>(args)...); assert(!Sentinel::is_empty(_Value)); return _Value; }
+    void reset() noexcept { _Value = Sentinel::empty_value(); }
+    void swap(compact_optional & other) { using std::swap; swap(_Value, other._Value); }
+
+    constexpr bool has_value() const noexcept { return !Sentinel::is_empty(_Value); }
+    constexpr explicit operator bool() const noexcept { return !Sentinel::is_empty(_Value); }
+
+    constexpr const T * operator->() const noexcept { return &_Value; }
+    T * operator->() noexcept { return &_Value; }
+    constexpr const T & operator*() const noexcept { return _Value; }
+    T & operator*() noexcept { return _Value; }
+
+    const T & value() const { if(Sentinel::is_empty(_Value)) throw std::bad_optional_access{}; return _Value; }
+    T & value() { if(Sentinel::is_empty(_Value)) throw std::bad_optional_access{}; return _Value; }
+    template<class U> constexpr T value_or(U && default_value) const { return Sentinel::is_empty(_Value) ? static_cast<T>(std::forward<U>(default_value)) : _Value; }
+
+    operator std::optional<T>() const { return Sentinel::is_empty(_Value) ? std::optional<T>{} : std::optional<T>{_Value}; }
+};
+
+namespace detail {
+
+template<class U> struct is_compact_optional : std::false_type {};
+template<class T, class S> struct is_compact_optional<compact_optional<T, S>> : std::true_type {};
+template<class U> using enable_if_not_compact_optional_t = std::enable_if_t<!is_compact_optional<U>::value && !std::_Early17::is_optional<U>::value && !std::is_same<U, std::nullopt_t>::value, bool>;
+
+} // namespace vocab::detail
+
+template<class T, class S> constexpr bool operator==(const compact_optional<T, S> & lhs, const compact_optional<T, S> & rhs) { return lhs.has_value() != rhs.has_value() ? false : !lhs.has_value() ? true : *lhs == *rhs; }
+template<class T, class S> constexpr bool operator!=(const compact_optional<T, S> & lhs, const compact_optional<T, S> & rhs) { return lhs.has_value() != rhs.has_value() ? true : !lhs.has_value() ? false : *lhs != *rhs; }
+template<class T, class S> constexpr bool operator< (const compact_optional<T, S> & lhs, const compact_optional<T, S> & rhs) { return !rhs.has_value() ? false : !lhs.has_value() ? true : *lhs < *rhs; }
+template<class T, class S> constexpr bool operator<=(const compact_optional<T, S> & lhs, const compact_optional<T, S> & rhs) { return !lhs.has_value() ? true : !rhs.has_value() ? false : *lhs <= *rhs; }
+template<class T, class S> constexpr bool operator> (const compact_optional<T, S> & lhs, const compact_optional<T, S> & rhs) { return !lhs.has_value() ? false : !rhs.has_value() ? true : *lhs > *rhs; }
+template<class T, class S> constexpr bool operator>=(const compact_optional<T, S> & lhs, const compact_optional<T, S> & rhs) { return !rhs.has_value() ? true : !lhs.has_value() ? false : *lhs >= *rhs; }
+
+template<class T, class S> constexpr bool operator==(const compact_optional<T, S> & opt, std::nullopt_t) { return !opt; }
+template<class T, class S> constexpr bool operator==(std::nullopt_t, const compact_optional<T, S> & opt) { return !opt; }
+template<class T, class S> constexpr bool operator!=(const compact_optional<T, S> & opt, std::nullopt_t) { return bool(opt); }
+template<class T, class S> constexpr bool operator!=(std::nullopt_t, const compact_optional<T, S> & opt) { return bool(opt); }
+template<class T, class S> constexpr bool operator< (const compact_optional<T, S> &, std::nullopt_t) { return false; }
+template<class T, class S> constexpr bool operator< (std::nullopt_t, const compact_optional<T, S> & opt) { return bool(opt); }
+template<class T, class S> constexpr bool operator<=(const compact_optional<T, S> & opt, std::nullopt_t) { return !opt; }
+template<class T, class S> constexpr bool operator<=(std::nullopt_t, const compact_optional<T, S> &) { return true; }
+template<class T, class S> constexpr bool operator> (const compact_optional<T, S> & opt, std::nullopt_t) { return bool(opt); }
+template<class T, class S> constexpr bool operator> (std::nullopt_t, const compact_optional<T, S> &) { return false; }
+template<class T, class S> constexpr bool operator>=(const compact_optional<T, S> &, std::nullopt_t) { return true; }
+template<class T, class S> constexpr bool operator>=(std::nullopt_t, const compact_optional<T, S> & opt) { return !opt; }
+
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator==(const compact_optional<T, S> & opt, const U & value) { return opt ? *opt == value : false; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator==(const U & value, const compact_optional<T, S> & opt) { return opt ? value == *opt : false; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator!=(const compact_optional<T, S> & opt, const U & value) { return opt ? *opt != value : true; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator!=(const U & value, const compact_optional<T, S> & opt) { return opt ? value != *opt : true; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator< (const compact_optional<T, S> & opt, const U & value) { return opt ? *opt <  value : true; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator< (const U & value, const compact_optional<T, S> & opt) { return opt ? value <  *opt : false; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator<=(const compact_optional<T, S> & opt, const U & value) { return opt ? *opt <= value : true; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator<=(const U & value, const compact_optional<T, S> & opt) { return opt ? value <= *opt : false; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator> (const compact_optional<T, S> & opt, const U & value) { return opt ? *opt >  value : false; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator> (const U & value, const compact_optional<T, S> & opt) { return opt ? value >  *opt : true; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator>=(const compact_optional<T, S> & opt, const U & value) { return opt ? *opt >= value : false; }
+template<class T, class S, class U, detail::enable_if_not_compact_optional_t<U> = true> constexpr bool operator>=(const U & value, const compact_optional<T, S> & opt) { return opt ? value >= *opt : true; }
+
+// A compact_optional compared with a std::optional<T> is compared as the equivalent std::optional<T>, so that empty
+// optionals of either kind are equal
+template<class T, class S> bool operator==(const compact_optional<T, S> & lhs, const std::optional<T> & rhs) { return std::optional<T>(lhs) == rhs; }
+template<class T, class S> bool operator==(const std::optional<T> & lhs, const compact_optional<T, S> & rhs) { return lhs == std::optional<T>(rhs); }
+template<class T, class S> bool operator!=(const compact_optional<T, S> & lhs, const std::optional<T> & rhs) { return std::optional<T>(lhs) != rhs; }
+template<class T, class S> bool operator!=(const std::optional<T> & lhs, const compact_optional<T, S> & rhs) { return lhs != std::optional<T>(rhs); }
+template<class T, class S> bool operator< (const compact_optional<T, S> & lhs, const std::optional<T> & rhs) { return std::optional<T>(lhs) < rhs; }
+template<class T, class S> bool operator< (const std::optional<T> & lhs, const compact_optional<T, S> & rhs) { return lhs < std::optional<T>(rhs); }
+template<class T, class S> bool operator<=(const compact_optional<T, S> & lhs, const std::optional<T> & rhs) { return std::optional<T>(lhs) <= rhs; }
+template<class T, class S> bool operator<=(const std::optional<T> & lhs, const compact_optional<T, S> & rhs) { return lhs <= std::optional<T>(rhs); }
+template<class T, class S> bool operator> (const compact_optional<T, S> & lhs, const std::optional<T> & rhs) { return std::optional<T>(lhs) > rhs; }
+template<class T, class S> bool operator> (const std::optional<T> & lhs, const compact_optional<T, S> & rhs) { return lhs > std::optional<T>(rhs); }
+template<class T, class S> bool operator>=(const compact_optional<T, S> & lhs, const std::optional<T> & rhs) { return std::optional<T>(lhs) >= rhs; }
+template<class T, class S> bool operator>=(const std::optional<T> & lhs, const compact_optional<T, S> & rhs) { return lhs >= std::optional<T>(rhs); }
+
+template<class T, class S> void swap(compact_optional<T, S> & lhs, compact_optional<T, S> & rhs) { lhs.swap(rhs); }
+
+} // namespace vocab
+
+namespace std {
+
+// Hashes as the equivalent std::optional<T> would
+template<class T, class S> struct hash<vocab::compact_optional<T, S>>
+{
+    size_t operator() (const vocab::compact_optional<T, S> & key) const noexcept { return key ? std::hash<T>{}(*key) : 0; }
+};
+
+} // namespace std
+
+#endif
@@ -0,0 +1,194 @@
+// cow_variant.h provides cow_variant, a copy-on-write variant for read-mostly
+// state shared between many threads, with epoch-based reclamation of old
+// versions. It is an extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_COW_VARIANT
+#define VOCAB_TYPES_COW_VARIANT
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "variant.h"
+
+namespace vocab {
+
+namespace detail {
+
+// Each thread receives a distinct hint the first time it reads any cow_variant, so that concurrent readers start
+// their search for a free reader slot in different places, and usually claim the first slot they try
+inline size_t reader_slot_hint()
+{
+    static std::atomic<size_t> next_hint {0};
+    static thread_local const size_t hint = next_hint.fetch_add(1, std::memory_order_relaxed);
+    return hint;
+}
+
+} // namespace vocab::detail
+
+//////////////////////////////////////////////////////////////////////////////////////
+// cow_variant - copy-on-write variant with lock-free readers and epoch reclamation //
+//////////////////////////////////////////////////////////////////////////////////////
+
+// Readers announce the current epoch in a reader slot, each of which occupies its own cache line, and then
+// load a pointer to the current version. Writers are serialized by a mutex, and publish a new version by
+// exchanging the pointer and advancing the epoch. A retired version is deleted once no reader slot holds
+// an epoch at or before the one in which it was retired. Readers therefore touch only the epoch counter,
+// the version pointer (both of which are read-only in the steady state), and a slot which no other thread
+// is using, so the read side scales with the number of cores.
+//
+// A snapshot occupies its slot until it is destroyed, so a thread which holds several snapshots at once holds as many
+// slots. When every slot is occupied, read() falls back to copying the current version under the writer mutex, so
+// that it never waits for a slot to be released, at the cost of an allocation and of blocking on writers.
+template<class... Types> class cow_variant
+{
+public:
+    typedef std::variant<Types...> value_type;
+private:
+    struct reader_slot { std::atomic<size_t> epoch {0}; char pad[64 - sizeof(std::atomic<size_t>)]; };
+    struct retired { const value_type * value; size_t epoch; };
+
+    std::atomic<size_t> _Epoch {1};
+    std::atomic<const value_type *> _Current;
+    std::unique_ptr<reader_slot[]> _Slots;
+    size_t _Slot_count;
+    mutable std::mutex _Writer_mutex;
+    std::vector<retired> _Retired;
+
+    // Must be called with _Writer_mutex held
+    void _Publish(std::unique_ptr<const value_type> value)
+    {
+        const value_type * old = _Current.exchange(value.release());
+        _Retired.push_back({old, _Epoch.fetch_add(1)});
+        _Reclaim();
+    }
+
+    void _Reclaim()
+    {
+        size_t oldest = static_cast<size_t>(-1);
+        for(size_t i=0; i<_Slot_count; ++i)
+        {
+            const size_t e = _Slots[i].epoch.load();
+            if(e && e < oldest) oldest = e;
+        }
+        auto it = _Retired.begin();
+        for(auto & r : _Retired)
+        {
+            if(r.epoch < oldest) delete r.value;
+            else *it++ = r;
+        }
+        _Retired.erase(it, _Retired.end());
+    }
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // snapshot - a handle which keeps one version of a cow_variant alive while it exists //
+    ////////////////////////////////////////////////////////////////////////////////////////
+
+    class snapshot
+    {
+        friend class cow_variant;
+        const value_type * _Value;
+        std::atomic<size_t> * _Slot;
+        std::unique_ptr<const value_type> _Copy;
+        snapshot(const value_type * value, std::atomic<size_t> * slot) : _Value{value}, _Slot{slot} {}
+        explicit snapshot(std::unique_ptr<const value_type> copy) : _Value{copy.get()}, _Slot{nullptr}, _Copy{std::move(copy)} {}
+    public:
+        snapshot(snapshot && r) : _Value{r._Value}, _Slot{r._Slot}, _Copy{std::move(r._Copy)} { r._Slot = nullptr; }
+        snapshot(const snapshot &) = delete;
+        snapshot & operator = (const snapshot &) = delete;
+        ~snapshot() { if(_Slot) _Slot->store(0, std::memory_order_release); }
+
+        const value_type & operator * () const { return *_Value; }
+        const value_type * operator -> () const { return _Value; }
+        template<class Visitor> auto visit(Visitor && vis) const { return std::visit(std::forward<Visitor>(vis), *_Value); }
+    };
+
+    // Constructs a cow_variant holding the given value, with reader_slots slots for concurrently live snapshots
+    explicit cow_variant(value_type value = value_type{}, size_t reader_slots = 4 * std::max(1u, std::thread::hardware_concurrency())) :
+        _Current{new value_type(std::move(value))}, _Slots{new reader_slot[reader_slots]}, _Slot_count{reader_slots} {}
+    cow_variant(const cow_variant &) = delete;
+    cow_variant & operator = (const cow_variant &) = delete;
+
+    // All snapshots must have been destroyed before the cow_variant itself is destroyed
+    ~cow_variant()
+    {
+        for(auto & r : _Retired) delete r.value;
+        delete _Current.load();
+    }
+
+    // Take a snapshot of the current version, which remains valid and unchanged until the snapshot is destroyed
+    snapshot read() const
+    {
+        const size_t hint = detail::reader_slot_hint();
+        for(size_t i = 0; i < _Slot_count; ++i)
+        {
+            std::atomic<size_t> & slot = _Slots[(hint + i) % _Slot_count].epoch;
+            size_t expected = 0;
+            if(slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(expected, _Epoch.load())) return snapshot{_Current.load(), &slot};
+        }
+        std::lock_guard<std::mutex> lock(_Writer_mutex);
+        return snapshot{std::unique_ptr<const value_type>{new value_type(*_Current.load())}};
+    }
+
+    // Visit a snapshot of the current version
+    template<class Visitor> auto visit(Visitor && vis) const { return read().visit(std::forward<Visitor>(vis)); }
+
+    // Publish a new version, which will be seen by all subsequent reads
+    void store(value_type value)
+    {
+        std::unique_ptr<const value_type> v {new value_type(std::move(value))};
+        std::lock_guard<std::mutex> lock(_Writer_mutex);
+        _Publish(std::move(v));
+    }
+    template<class T, class... Args> void emplace(Args &&... args)
+    {
+        std::unique_ptr<const value_type> v {new value_type(std::in_place<std::_Early17::index_of<T, Types...>::value>, std::forward<Args>(args)...)};
+        std::lock_guard<std::mutex> lock(_Writer_mutex);
+        _Publish(std::move(v));
+    }
+
+    // Publish a copy of the current version as modified by f(value_type &). Concurrent updates are serialized,
+    // so no update is lost.
+    template<class F> void update(F && f)
+    {
+        std::lock_guard<std::mutex> lock(_Writer_mutex);
+        std::unique_ptr<value_type> v {new value_type(*_Current.load())};
+        f(*v);
+        _Publish(std::move(v));
+    }
+
+    // Delete any retired versions which are no longer visible to any snapshot
+    void reclaim() { std::lock_guard<std::mutex> lock(_Writer_mutex); _Reclaim(); }
+};
+
+} // namespace vocab
+
+#endif
@@ -0,0 +1,352 @@
+// expected.h is an independent implementation of the C++23 <expected>
+// standard library header, which can be compiled by C++14 compliant
+// compilers. Its permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef EARLY17_EXPECTED
+#define EARLY17_EXPECTED
+
+#include "utility.h"
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace std {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+// unexpected_type, make_unexpected - http://en.cppreference.com/w/cpp/utility/expected/unexpected //
+/////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// C++14's <exception> declares the function std::unexpected(), so the class template which C++23 calls unexpected
+// is provided under the name it had in the original proposal, N4015, along with its make_unexpected helper.
+template<class E> class unexpected_type
+{
+    E _Error;
+public:
+    unexpected_type(const unexpected_type &) = default;
+    unexpected_type(unexpected_type &&) = default;
+    template<class Err = E, class = enable_if_t<!is_same<decay_t<Err>, unexpected_type>::value && !is_same<decay_t<Err>, decay_t<in_place_t>>::value && is_constructible<E, Err>::value>> constexpr explicit unexpected_type(Err && e) : _Error(std::forward<Err>(e)) {}
+    template<class... Args> constexpr explicit unexpected_type(in_place_t, Args &&... args) : _Error(std::forward<Args>(args)...) {}
+
+    constexpr const E & error() const & noexcept { return _Error; }
+    E & error() & noexcept { return _Error; }
+    E && error() && noexcept { return std::move(_Error); }
+
+    void swap(unexpected_type & other) { using std::swap; swap(_Error, other._Error); }
+};
+
+template<class E1, class E2> constexpr bool operator==(const unexpected_type<E1> & x, const unexpected_type<E2> & y) { return x.error() == y.error(); }
+template<class E1, class E2> constexpr bool operator!=(const unexpected_type<E1> & x, const unexpected_type<E2> & y) { return x.error() != y.error(); }
+
+template<class E> constexpr unexpected_type<decay_t<E>> make_unexpected(E && e) { return unexpected_type<decay_t<E>>(std::forward<E>(e)); }
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// bad_expected_access - http://en.cppreference.com/w/cpp/utility/expected/bad_expected_access //
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<class E> class bad_expected_access;
+template<> class bad_expected_access<void> : public std::exception { public: const char * what() const noexcept override { return "bad_expected_access"; } };
+template<class E> class bad_expected_access : public bad_expected_access<void>
+{
+    E _Error;
+public:
+    explicit bad_expected_access(E e) : _Error(std::move(e)) {}
+    const E & error() const & noexcept { return _Error; }
+    E & error() & noexcept { return _Error; }
+    E && error() && noexcept { return std::move(_Error); }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// unexpect - http://en.cppreference.com/w/cpp/utility/expected/unexpect_t //
+/////////////////////////////////////////////////////////////////////////////
+
+struct unexpect_t { constexpr explicit unexpect_t() {} };
+constexpr unexpect_t unexpect {};
+
+namespace _Early17 {
+
+// The value or error lives in an aligned_union, as the alternatives of a variant do, with a bool discriminator.
+// When both T and E are trivially copyable, expected_storage declares no special members of its own, so that
+// expected<T, E> is itself trivially copyable and trivially destructible, and small ones are returned in registers.
+template<class T, class E> struct expected_storage_base
+{
+    aligned_union_t<0, T, E> _Storage;
+    bool _Has_value;
+
+    T & _Val() noexcept { return reinterpret_cast<T &>(_Storage); }
+    const T & _Val() const noexcept { return reinterpret_cast<const T &>(_Storage); }
+    E & _Err() noexcept { return reinterpret_cast<E &>(_Storage); }
+    const E & _Err() const noexcept { return reinterpret_cast<const E &>(_Storage); }
+
+    template<class... Args> void _Construct_value(Args &&... args) { new(&_Storage) T(std::forward<Args>(args)...); _Has_value = true; }
+    template<class... Args> void _Construct_error(Args &&... args) { new(&_Storage) E(std::forward<Args>(args)...); _Has_value = false; }
+    void _Destroy() noexcept { if(_Has_value) _Val().~T(); else _Err().~E(); }
+
+    void _Construct(const expected_storage_base & r) { if(r._Has_value) _Construct_value(r._Val()); else _Construct_error(r._Err()); }
+    void _Construct(expected_storage_base && r) { if(r._Has_value) _Construct_value(std::move(r._Val())); else _Construct_error(std::move(r._Err())); }
+
+    // Replace the current alternative, of type Old, with a New constructed from args, in the manner of std::expected's
+    // reinit-expected: if constructing the New could throw, it is built in a temporary before the Old is destroyed,
+    // and if moving that temporary into place could also throw, the Old is moved aside first, and restored on failure,
+    // so that *this never names an alternative which has been destroyed
+    template<class New, class Old, class... Args> void _Reinit(Args &&... args)
+    {
+        _Reinit_as<New, Old>(integral_constant<int, is_nothrow_constructible<New, Args...>::value ? 0 : is_nothrow_move_constructible<New>::value ? 1 : 2>{}, std::forward<Args>(args)...);
+    }
+    template<class New, class Old, class... Args> void _Reinit_as(integral_constant<int, 0>, Args &&... args)
+    {
+        reinterpret_cast<Old &>(_Storage).~Old();
+        new(&_Storage) New(std::forward<Args>(args)...);
+    }
+    template<class New, class Old, class... Args> void _Reinit_as(integral_constant<int, 1>, Args &&... args)
+    {
+        New temp(std::forward<Args>(args)...);
+        reinterpret_cast<Old &>(_Storage).~Old();
+        new(&_Storage) New(std::move(temp));
+    }
+    template<class New, class Old, class... Args> void _Reinit_as(integral_constant<int, 2>, Args &&... args)
+    {
+        static_assert(is_nothrow_move_constructible<Old>::value, "replacing an alternative requires that one of T and E be nothrow move constructible");
+        Old backup(std::move(reinterpret_cast<Old &>(_Storage)));
+        reinterpret_cast<Old &>(_Storage).~Old();
+        try { new(&_Storage) New(std::forward<Args>(args)...); }
+        catch(...) { new(&_Storage) Old(std::move(backup)); throw; }
+    }
+
+    void _Assign(const expected_storage_base & r)
+    {
+        if(_Has_value && r._Has_value) _Val() = r._Val();
+        else if(!_Has_value && !r._Has_value) _Err() = r._Err();
+        else if(r._Has_value) { _Reinit<T, E>(r._Val()); _Has_value = true; }
+        else { _Reinit<E, T>(r._Err()); _Has_value = false; }
+    }
+    void _Assign(expected_storage_base && r)
+    {
+        if(_Has_value && r._Has_value) _Val() = std::move(r._Val());
+        else if(!_Has_value && !r._Has_value) _Err() = std::move(r._Err());
+        else if(r._Has_value) { _Reinit<T, E>(std::move(r._Val())); _Has_value = true; }
+        else { _Reinit<E, T>(std::move(r._Err())); _Has_value = false; }
+    }
+};
+template<class T, class E, bool Trivial = is_trivially_copyable<T>::value && is_trivially_copyable<E>::value> struct expected_storage : expected_storage_base<T, E> {};
+template<class T, class E> struct expected_storage<T, E, false> : expected_storage_base<T, E>
+{
+    expected_storage() = default;
+    expected_storage(const expected_storage & r) { this->_Construct(r); }
+    expected_storage(expected_storage && r) { this->_Construct(std::move(r)); }
+    expected_storage & operator=(const expected_storage & r) { this->_Assign(r); return *this; }
+    expected_storage & operator=(expected_storage && r) { this->_Assign(std::move(r)); return *this; }
+    ~expected_storage() { this->_Destroy(); }
+};
+
+template<class T> struct is_expected : false_type {};
+
+} // namespace std::_Early17
+
+//////////////////////////////////////////////////////////////////
+// expected - http://en.cppreference.com/w/cpp/utility/expected //
+//////////////////////////////////////////////////////////////////
+
+template<class T, class E> class expected : _Early17::expected_storage<T, E>
+{
+    template<class U> using _Not_special = integral_constant<bool, !is_same<decay_t<U>, expected>::value && !is_same<decay_t<U>, decay_t<in_place_t>>::value && !is_same<decay_t<U>, unexpect_t>::value>;
+public:
+    typedef T value_type;
+    typedef E error_type;
+    template<class U> using rebind = expected<U, error_type>;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // (constructor) - http://en.cppreference.com/w/cpp/utility/expected/expected //
+    ////////////////////////////////////////////////////////////////////////////////
+
+    expected() { this->_Construct_value(); } // (1)
+    expected(const expected &) = default; // (2)
+    expected(expected &&) = default; // (3)
+    template<class U = T, class = enable_if_t<_Not_special<U>::value && is_constructible<T, U>::value>> expected(U && v) { this->_Construct_value(std::forward<U>(v)); } // (6)
+    template<class G> expected(const unexpected_type<G> & e) { this->_Construct_error(e.error()); } // (7)
+    template<class G> expected(unexpected_type<G> && e) { this->_Construct_error(std::move(e).error()); } // (8)
+    template<class... Args> explicit expected(in_place_t, Args &&... args) { this->_Construct_value(std::forward<Args>(args)...); } // (9)
+    template<class... Args> explicit expected(unexpect_t, Args &&... args) { this->_Construct_error(std::forward<Args>(args)...); } // (12)
+
+    ///////////////////////////////////////////////////////////////////////////////
+    // operator= - http://en.cppreference.com/w/cpp/utility/expected/operator%3D //
+    ///////////////////////////////////////////////////////////////////////////////
+
+    expected & operator=(const expected &) = default; // (1)
+    expected & operator=(expected &&) = default; // (2)
+    template<class U = T, class = enable_if_t<_Not_special<U>::value && is_constructible<T, U>::value>> expected & operator=(U && v) // (3)
+    {
+        if(this->_Has_value) this->_Val() = std::forward<U>(v);
+        else { this->template _Reinit<T, E>(std::forward<U>(v)); this->_Has_value = true; }
+        return *this;
+    }
+    template<class G> expected & operator=(const unexpected_type<G> & e) { return *this = expected(e); } // (4)
+    template<class G> expected & operator=(unexpected_type<G> && e) { return *this = expected(std::move(e)); } // (5)
+
+    /////////////////////////////////////////////////////////////////////////
+    // emplace - http://en.cppreference.com/w/cpp/utility/expected/emplace //
+    /////////////////////////////////////////////////////////////////////////
+
+    template<class... Args> T & emplace(Args &&... args)
+    {
+        if(this->_Has_value) { T temp(std::forward<Args>(args)...); this->_Val() = std::move(temp); }
+        else { this->template _Reinit<T, E>(std::forward<Args>(args)...); this->_Has_value = true; }
+        return this->_Val();
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // operator->, operator* - http://en.cppreference.com/w/cpp/utility/expected/operator* //
+    /////////////////////////////////////////////////////////////////////////////////////////
+
+    const T * operator->() const noexcept { return &this->_Val(); }
+    T * operator->() noexcept { return &this->_Val(); }
+    const T & operator*() const & noexcept { return this->_Val(); }
+    T & operator*() & noexcept { return this->_Val(); }
+    T && operator*() && noexcept { return std::move(this->_Val()); }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // operator bool, has_value - http://en.cppreference.com/w/cpp/utility/expected/operator_bool //
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+    constexpr explicit operator bool() const noexcept { return this->_Has_value; }
+    constexpr bool has_value() const noexcept { return this->_Has_value; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // value, error - http://en.cppreference.com/w/cpp/utility/expected/value //
+    ////////////////////////////////////////////////////////////////////////////
+
+    T & value() & { if(!this->_Has_value) throw bad_expected_access<E>(this->_Err()); return this->_Val(); }
+    const T & value() const & { if(!this->_Has_value) throw bad_expected_access<E>(this->_Err()); return this->_Val(); }
+    T && value() && { if(!this->_Has_value) throw bad_expected_access<E>(std::move(this->_Err())); return std::move(this->_Val()); }
+
+    const E & error() const & noexcept { return this->_Err(); }
+    E & error() & noexcept { return this->_Err(); }
+    E && error() && noexcept { return std::move(this->_Err()); }
+
+    /////////////////////////////////////////////////////////////////////////////////////
+    // value_or, error_or - http://en.cppreference.com/w/cpp/utility/expected/value_or //
+    /////////////////////////////////////////////////////////////////////////////////////
+
+    template<class U> T value_or(U && default_value) const & { return this->_Has_value ? this->_Val() : static_cast<T>(std::forward<U>(default_value)); }
+    template<class U> T value_or(U && default_value) && { return this->_Has_value ? std::move(this->_Val()) : static_cast<T>(std::forward<U>(default_value)); }
+    template<class G = E> E error_or(G && default_error) const & { return this->_Has_value ? static_cast<E>(std::forward<G>(default_error)) : this->_Err(); }
+    template<class G = E> E error_or(G && default_error) && { return this->_Has_value ? static_cast<E>(std::forward<G>(default_error)) : std::move(this->_Err()); }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // and_then - http://en.cppreference.com/w/cpp/utility/expected/and_then //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // f(value) must return an expected with the same error type. On error, the error is propagated without calling f.
+    template<class F> auto and_then(F && f) & { return _And_then(std::forward<F>(f), this->_Val(), this->_Err()); }
+    template<class F> auto and_then(F && f) const & { return _And_then(std::forward<F>(f), this->_Val(), this->_Err()); }
+    template<class F> auto and_then(F && f) && { return _And_then(std::forward<F>(f), std::move(this->_Val()), std::move(this->_Err())); }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // transform - http://en.cppreference.com/w/cpp/utility/expected/transform //
+    /////////////////////////////////////////////////////////////////////////////
+
+    // Wrap f(value) in an expected with the same error type
+    template<class F> auto transform(F && f) & { return _Transform(std::forward<F>(f), this->_Val(), this->_Err()); }
+    template<class F> auto transform(F && f) const & { return _Transform(std::forward<F>(f), this->_Val(), this->_Err()); }
+    template<class F> auto transform(F && f) && { return _Transform(std::forward<F>(f), std::move(this->_Val()), std::move(this->_Err())); }
+
+    /////////////////////////////////////////////////////////////////////////
+    // or_else - http://en.cppreference.com/w/cpp/utility/expected/or_else //
+    /////////////////////////////////////////////////////////////////////////
+
+    // f(error) must return an expected with the same value type. On success, the value is propagated without calling f.
+    template<class F> auto or_else(F && f) & { return _Or_else(std::forward<F>(f), this->_Val(), this->_Err()); }
+    template<class F> auto or_else(F && f) const & { return _Or_else(std::forward<F>(f), this->_Val(), this->_Err()); }
+    template<class F> auto or_else(F && f) && { return _Or_else(std::forward<F>(f), std::move(this->_Val()), std::move(this->_Err())); }
+
+    /////////////////////////////////////////////////////////////////////////////////////////
+    // transform_error - http://en.cppreference.com/w/cpp/utility/expected/transform_error //
+    /////////////////////////////////////////////////////////////////////////////////////////
+
+    // Wrap f(error) in an expected with the same value type
+    template<class F> auto transform_error(F && f) & { return _Transform_error(std::forward<F>(f), this->_Val(), this->_Err()); }
+    template<class F> auto transform_error(F && f) const & { return _Transform_error(std::forward<F>(f), this->_Val(), this->_Err()); }
+    template<class F> auto transform_error(F && f) && { return _Transform_error(std::forward<F>(f), std::move(this->_Val()), std::move(this->_Err())); }
+
+    ///////////////////////////////////////////////////////////////////
+    // swap - http://en.cppreference.com/w/cpp/utility/expected/swap //
+    ///////////////////////////////////////////////////////////////////
+
+    void swap(expected & other) { expected temp(std::move(other)); other = std::move(*this); *this = std::move(temp); }
+
+private:
+    // V and G are the value and error of *this, forwarded with the value category of *this. Only the one selected by
+    // _Has_value is ever accessed.
+    template<class F, class V, class G> auto _And_then(F && f, V && v, G && g) const
+    {
+        typedef decay_t<decltype(std::forward<F>(f)(std::forward<V>(v)))> R;
+        static_assert(_Early17::is_expected<R>::value, "and_then requires f to return an expected");
+        static_assert(is_same<typename R::error_type, E>::value, "and_then requires f to return an expected with the same error type");
+        return this->_Has_value ? std::forward<F>(f)(std::forward<V>(v)) : R(unexpect, std::forward<G>(g));
+    }
+    template<class F, class V, class G> auto _Transform(F && f, V && v, G && g) const
+    {
+        typedef expected<decay_t<decltype(std::forward<F>(f)(std::forward<V>(v)))>, E> R;
+        return this->_Has_value ? R(in_place, std::forward<F>(f)(std::forward<V>(v))) : R(unexpect, std::forward<G>(g));
+    }
+    template<class F, class V, class G> auto _Or_else(F && f, V && v, G && g) const
+    {
+        typedef decay_t<decltype(std::forward<F>(f)(std::forward<G>(g)))> R;
+        static_assert(_Early17::is_expected<R>::value, "or_else requires f to return an expected");
+        static_assert(is_same<typename R::value_type, T>::value, "or_else requires f to return an expected with the same value type");
+        return this->_Has_value ? R(in_place, std::forward<V>(v)) : std::forward<F>(f)(std::forward<G>(g));
+    }
+    template<class F, class V, class G> auto _Transform_error(F && f, V && v, G && g) const
+    {
+        typedef expected<T, decay_t<decltype(std::forward<F>(f)(std::forward<G>(g)))>> R;
+        return this->_Has_value ? R(in_place, std::forward<V>(v)) : R(unexpect, std::forward<F>(f)(std::forward<G>(g)));
+    }
+};
+
+namespace _Early17 { template<class T, class E> struct is_expected<expected<T, E>> : true_type {}; }
+
+/////////////////////////////////////////////////////////////////////////////////////
+// operator==, != - http://en.cppreference.com/w/cpp/utility/expected/operator_cmp //
+/////////////////////////////////////////////////////////////////////////////////////
+
+template<class T1, class E1, class T2, class E2> bool operator==(const expected<T1, E1> & x, const expected<T2, E2> & y) { return x.has_value() != y.has_value() ? false : x.has_value() ? *x == *y : x.error() == y.error(); } // (1)
+template<class T1, class E1, class T2, class E2> bool operator!=(const expected<T1, E1> & x, const expected<T2, E2> & y) { return !(x == y); } // (1)
+template<class T1, class E1, class T2, class = enable_if_t<!_Early17::is_expected<T2>::value>> bool operator==(const expected<T1, E1> & x, const T2 & v) { return x.has_value() && *x == v; } // (2)
+template<class T1, class E1, class T2, class = enable_if_t<!_Early17::is_expected<T2>::value>> bool operator!=(const expected<T1, E1> & x, const T2 & v) { return !(x == v); } // (2)
+template<class T1, class E1, class E2> bool operator==(const expected<T1, E1> & x, const unexpected_type<E2> & e) { return !x.has_value() && x.error() == e.error(); } // (3)
+template<class T1, class E1, class E2> bool operator!=(const expected<T1, E1> & x, const unexpected_type<E2> & e) { return !(x == e); } // (3)
+
+////////////////////////////////////////////////////////////////////
+// swap - http://en.cppreference.com/w/cpp/utility/expected/swap2 //
+////////////////////////////////////////////////////////////////////
+
+template<class T, class E> void swap(expected<T, E> & lhs, expected<T, E> & rhs) { lhs.swap(rhs); }
+
+} // namespace std
+
+#endif
@@ -0,0 +1,63 @@
+// explicit_instantiation.h provides generator macros which declare and define
+// explicit instantiations of std::optional and std::variant for a list of
+// types, so that a program can compile them once into a library rather than
+// in every translation unit. It is an extension to vocab-types, and its
+// permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_EXPLICIT_INSTANTIATION
+#define VOCAB_TYPES_EXPLICIT_INSTANTIATION
+
+#include "optional.h"
+#include "variant.h"
+
+//////////////////////////////////////////////////////////////////////////////////
+// VOCAB_EXTERN_TEMPLATES, VOCAB_INSTANTIATE_TEMPLATES - instantiate types once //
+//////////////////////////////////////////////////////////////////////////////////
+
+// A list of instantiations is written once, as a macro which takes the names of an OPTIONAL and a VARIANT macro and
+// applies them to each type the program uses:
+//
+//     #define MY_VOCAB_TYPES(OPTIONAL, VARIANT) OPTIONAL(int) OPTIONAL(std::string) VARIANT(int, double, std::string)
+//
+// VOCAB_EXTERN_TEMPLATES(MY_VOCAB_TYPES) is then placed in a header which every translation unit includes, where it
+// declares each listed class as extern, and VOCAB_INSTANTIATE_TEMPLATES(MY_VOCAB_TYPES) in exactly one source file,
+// where it defines them. Only the member functions of the classes are instantiated; comparisons, visit, get and hash
+// are function templates and are still instantiated where they are used. A program which never expands
+// VOCAB_EXTERN_TEMPLATES is unaffected, and continues to instantiate everything in the translation units which use it.
+//
+// Explicit instantiation compiles every member function of a class, so each listed alternative must be copyable and
+// movable, as std::variant's copy and move operations are not disabled for types which are not.
+#define VOCAB_EXTERN_OPTIONAL(T) extern template class std::optional<T>;
+#define VOCAB_EXTERN_VARIANT(...) extern template class std::variant<__VA_ARGS__>;
+#define VOCAB_INSTANTIATE_OPTIONAL(T) template class std::optional<T>;
+#define VOCAB_INSTANTIATE_VARIANT(...) template class std::variant<__VA_ARGS__>;
+
+#define VOCAB_EXTERN_TEMPLATES(LIST) LIST(VOCAB_EXTERN_OPTIONAL, VOCAB_EXTERN_VARIANT)
+#define VOCAB_INSTANTIATE_TEMPLATES(LIST) LIST(VOCAB_INSTANTIATE_OPTIONAL, VOCAB_INSTANTIATE_VARIANT)
+
+#endif
@@ -0,0 +1,89 @@
+// lazy.h provides lazy, which holds a value that is constructed in place, in
+// thread-safe fashion, the first time it is accessed. It is an extension to
+// vocab-types, and its permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_LAZY
+#define VOCAB_TYPES_LAZY
+
+#include <atomic>
+#include <mutex>
+#include "optional.h"
+
+namespace vocab {
+
+////////////////////////////////////////////////////////////////////////////
+// lazy - a value constructed in place, once, the first time it is needed //
+////////////////////////////////////////////////////////////////////////////
+
+// A lazy<T, F> holds an initializer of type F, and storage for a T, in the same inline storage as std::optional<T>.
+// The first access to the value constructs it in place from the result of calling the initializer, or by value
+// initialization if a lazy<T> is default constructed. Every later access costs a single acquire load of a flag, and
+// takes no lock. The first accesses, from any number of threads, construct the value exactly once, under a std::mutex,
+// and none returns until it has been constructed. If the initializer throws, the exception propagates to the thread
+// which called it, and the next access tries again.
+//
+// The constructors of lazy are constexpr, so that a lazy with static storage duration is constant initialized, and
+// costs nothing at startup. lazy never allocates, unless T or F does. It is neither copyable nor movable, and a
+// capturing lambda can be used as its initializer by naming its type, as in lazy<T, decltype(f)> x {f}.
+template<class T, class F = T (*)()> class lazy
+{
+    mutable std::_Early17::optional_storage<T> _Storage;
+    mutable std::atomic<bool> _Ready;
+    mutable std::mutex _Mutex;
+    mutable F _Init;
+
+    static T _Value_initialize() { return T(); }
+    void _Initialize() const
+    {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if(_Ready.load(std::memory_order_relaxed)) return;
+        _Storage._Construct_from_result(_Init);
+        _Ready.store(true, std::memory_order_release);
+    }
+public:
+    typedef T value_type;
+
+    constexpr lazy() : _Storage{}, _Ready{false}, _Mutex{}, _Init{&_Value_initialize} {}
+    constexpr explicit lazy(F init) : _Storage{}, _Ready{false}, _Mutex{}, _Init(std::move(init)) {}
+    lazy(const lazy &) = delete;
+    lazy & operator=(const lazy &) = delete;
+
+    // Whether the value has been constructed, which, once true, remains true
+    bool has_value() const noexcept { return _Ready.load(std::memory_order_acquire); }
+
+    T & get() { if(!_Ready.load(std::memory_order_acquire)) _Initialize(); return _Storage._Val; }
+    const T & get() const { if(!_Ready.load(std::memory_order_acquire)) _Initialize(); return _Storage._Val; }
+    T & operator*() { return get(); }
+    const T & operator*() const { return get(); }
+    T * operator->() { return &get(); }
+    const T * operator->() const { return &get(); }
+};
+
+} // namespace vocab
+
+#endif
@@ -0,0 +1,213 @@
+// memo_cache.h provides memo_cache, a bounded, sharded and thread-safe cache
+// of the results of a function of a variant, with lookup by alternative and
+// deduplication of concurrent computations of the same key. It is an
+// extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_MEMO_CACHE
+#define VOCAB_TYPES_MEMO_CACHE
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "variant.h"
+#include "optional.h"
+
+namespace vocab {
+
+template<class Key, class Value> class memo_cache;
+
+//////////////////////////////////////////////////////////////////////////////////
+// memo_cache - bounded CLOCK cache keyed by a variant, safe for concurrent use //
+//////////////////////////////////////////////////////////////////////////////////
+
+// Keys are distributed over independently locked shards by std::hash<std::variant<Keys...>>. Each shard holds a
+// fixed number of entries, and when it is full, evicts the first entry found by a CLOCK hand which has not been hit
+// since the hand last passed it. Every lookup accepts either a key_type or a value of one of the alternative types,
+// which is hashed and compared exactly as the equivalent variant would be, without constructing a variant.
+//
+// get_or_compute calls f() only if the key is neither cached nor already being computed by another thread. Threads
+// which request a key while it is being computed wait for that computation, and share its result or exception.
+template<class... Keys, class Value> class memo_cache<std::variant<Keys...>, Value>
+{
+public:
+    typedef std::variant<Keys...> key_type;
+    typedef Value mapped_type;
+private:
+    struct entry { key_type key; Value value; size_t hash; bool referenced; };
+    struct pending { key_type key; std::shared_future<Value> result; };
+    struct shard
+    {
+        std::mutex mutex;
+        std::vector<entry> entries;
+        std::unordered_multimap<size_t, size_t> index; // Hash to position in entries
+        std::unordered_multimap<size_t, std::shared_ptr<pending>> in_flight;
+        size_t hand = 0;
+    };
+
+    std::unique_ptr<shard[]> _Shards;
+    size_t _Shard_count, _Shard_capacity;
+
+    // Hash and compare alternatives as std::hash<variant> and variant's operator== would
+    static size_t _Hash(const key_type & key) { return std::hash<key_type>{}(key); }
+    template<class K> static size_t _Hash(const K & key) { return std::_Early17::index_of<K, Keys...>::value ^ std::hash<K>{}(key); }
+    static bool _Equal(const key_type & a, const key_type & b) { return a == b; }
+    template<class K> static bool _Equal(const key_type & a, const K & b)
+    {
+        constexpr size_t I = std::_Early17::index_of<K, Keys...>::value;
+        return a.index() == I && a.template _Unchecked_get<I>() == b;
+    }
+    static const key_type & _Make_key(const key_type & key) { return key; }
+    template<class K> static key_type _Make_key(const K & key) { return key_type(std::in_place<std::_Early17::index_of<K, Keys...>::value>, key); }
+
+    shard & _Shard(size_t hash) const
+    {
+        hash ^= hash >> 16; hash *= 0x45d9f3b; hash ^= hash >> 16;
+        return _Shards[hash % _Shard_count];
+    }
+    template<class K> entry * _Find(shard & s, size_t hash, const K & key)
+    {
+        auto range = s.index.equal_range(hash);
+        for(auto it = range.first; it != range.second; ++it) if(_Equal(s.entries[it->second].key, key)) return &s.entries[it->second];
+        return nullptr;
+    }
+    template<class K> std::shared_ptr<pending> _Find_pending(shard & s, size_t hash, const K & key)
+    {
+        auto range = s.in_flight.equal_range(hash);
+        for(auto it = range.first; it != range.second; ++it) if(_Equal(it->second->key, key)) return it->second;
+        return nullptr;
+    }
+    void _Erase_pending(shard & s, size_t hash, const pending * p)
+    {
+        auto range = s.in_flight.equal_range(hash);
+        for(auto it = range.first; it != range.second; ++it) if(it->second.get() == p) { s.in_flight.erase(it); return; }
+    }
+    void _Insert(shard & s, size_t hash, key_type key, Value value)
+    {
+        if(entry * e = _Find(s, hash, key)) { e->value = std::move(value); return; }
+        size_t slot = s.entries.size();
+        if(slot < _Shard_capacity) s.entries.push_back({std::move(key), std::move(value), hash, false});
+        else
+        {
+            while(s.entries[s.hand].referenced) { s.entries[s.hand].referenced = false; s.hand = (s.hand + 1) % _Shard_capacity; }
+            slot = s.hand;
+            s.hand = (s.hand + 1) % _Shard_capacity;
+            auto range = s.index.equal_range(s.entries[slot].hash);
+            for(auto it = range.first; it != range.second; ++it) if(it->second == slot) { s.index.erase(it); break; }
+            s.entries[slot] = {std::move(key), std::move(value), hash, false};
+        }
+        s.index.emplace(hash, slot);
+    }
+public:
+    // Constructs an empty cache which holds at most capacity entries, rounded up to a multiple of shard_count
+    explicit memo_cache(size_t capacity, size_t shard_count = 16) : _Shards{new shard[shard_count]}, _Shard_count{shard_count}, _Shard_capacity{std::max<size_t>((capacity + shard_count - 1) / shard_count, 1)} {}
+    memo_cache(const memo_cache &) = delete;
+    memo_cache & operator = (const memo_cache &) = delete;
+
+    size_t capacity() const { return _Shard_capacity * _Shard_count; }
+    size_t size() const
+    {
+        size_t n = 0;
+        for(size_t i=0; i<_Shard_count; ++i) { std::lock_guard<std::mutex> lock(_Shards[i].mutex); n += _Shards[i].entries.size(); }
+        return n;
+    }
+    void clear()
+    {
+        for(size_t i=0; i<_Shard_count; ++i)
+        {
+            std::lock_guard<std::mutex> lock(_Shards[i].mutex);
+            _Shards[i].entries.clear();
+            _Shards[i].index.clear();
+            _Shards[i].hand = 0;
+        }
+    }
+
+    // Returns a copy of the cached value for key, which may be a key_type or a value of one of Keys..., if present
+    template<class K> std::optional<Value> find(const K & key)
+    {
+        const size_t hash = _Hash(key);
+        shard & s = _Shard(hash);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if(entry * e = _Find(s, hash, key)) { e->referenced = true; return e->value; }
+        return std::nullopt;
+    }
+
+    // Caches value for key, replacing any value already cached
+    template<class K> void insert_or_assign(const K & key, Value value)
+    {
+        const size_t hash = _Hash(key);
+        shard & s = _Shard(hash);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        _Insert(s, hash, _Make_key(key), std::move(value));
+    }
+
+    // Returns the cached value for key, or the result of f(), which is cached. No lock is held while f() runs.
+    template<class K, class F> Value get_or_compute(const K & key, F && f)
+    {
+        const size_t hash = _Hash(key);
+        shard & s = _Shard(hash);
+        std::unique_lock<std::mutex> lock(s.mutex);
+        if(entry * e = _Find(s, hash, key)) { e->referenced = true; return e->value; }
+        if(auto p = _Find_pending(s, hash, key))
+        {
+            lock.unlock();
+            return p->result.get();
+        }
+
+        std::promise<Value> promise;
+        auto p = std::make_shared<pending>(pending{_Make_key(key), promise.get_future().share()});
+        s.in_flight.emplace(hash, p);
+        lock.unlock();
+
+        Value value = [&]() -> Value
+        {
+            try { return f(); }
+            catch(...)
+            {
+                lock.lock();
+                _Erase_pending(s, hash, p.get());
+                lock.unlock();
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+        }();
+        lock.lock();
+        _Erase_pending(s, hash, p.get());
+        _Insert(s, hash, std::move(p->key), value);
+        lock.unlock();
+        promise.set_value(value);
+        return value;
+    }
+};
+
+} // namespace vocab
+
+#endif
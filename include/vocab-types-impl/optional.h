@@ -31,7 +31,12 @@
 #ifndef EARLY17_OPTIONAL
 #define EARLY17_OPTIONAL
 
-#include "variant.h"
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include "utility.h"
 
 namespace std {
 
@@ -48,10 +53,77 @@ constexpr nullopt_t nullopt {0};
 
 class bad_optional_access : public std::exception { public: bad_optional_access() : std::exception() {} const char * what() const noexcept override { return "bad_optional_access"; } };
 
-template<class T> class optional
+template<class T> class optional;
+
+namespace _Early17 {
+
+template<class U> struct is_optional : false_type {};
+template<class T> struct is_optional<optional<T>> : true_type {};
+
+// The value lives in an anonymous union beside a bool, so that optional<T> is only as large as T plus the alignment
+// padding of one byte, and its constructors can be constexpr. The union member is only destroyed explicitly, and
+// only when T is not trivially destructible.
+template<class T, bool = is_trivially_destructible<T>::value> struct optional_value
+{
+    union { char _Empty; T _Val; };
+    bool _Has_value;
+
+    constexpr optional_value() noexcept : _Empty{}, _Has_value{false} {}
+    template<class... Args> constexpr explicit optional_value(in_place_t, Args &&... args) : _Val(std::forward<Args>(args)...), _Has_value{true} {}
+    template<class F> explicit optional_value(in_place_from_t, F && f) : _Val(std::forward<F>(f)()), _Has_value{true} {}
+};
+template<class T> struct optional_value<T, false>
+{
+    union { char _Empty; T _Val; };
+    bool _Has_value;
+
+    constexpr optional_value() noexcept : _Empty{}, _Has_value{false} {}
+    template<class... Args> constexpr explicit optional_value(in_place_t, Args &&... args) : _Val(std::forward<Args>(args)...), _Has_value{true} {}
+    template<class F> explicit optional_value(in_place_from_t, F && f) : _Val(std::forward<F>(f)()), _Has_value{true} {}
+    ~optional_value() { if(_Has_value) _Val.~T(); }
+};
+
+template<class T> struct optional_storage_base : optional_value<T>
+{
+    using optional_value<T>::optional_value;
+    optional_storage_base() = default;
+
+    template<class... Args> void _Construct(Args &&... args) { new(&this->_Val) T(std::forward<Args>(args)...); this->_Has_value = true; }
+    template<class F> void _Construct_from_result(F && f) { new(&this->_Val) T(std::forward<F>(f)()); this->_Has_value = true; }
+    void _Destroy() noexcept { if(this->_Has_value) { this->_Val.~T(); this->_Has_value = false; } }
+
+    template<class Storage> void _Construct_from(Storage && r) { if(r._Has_value) _Construct(std::forward<Storage>(r)._Val); }
+    template<class Storage> void _Assign_from(Storage && r)
+    {
+        if(this->_Has_value && r._Has_value) this->_Val = std::forward<Storage>(r)._Val;
+        else if(r._Has_value) _Construct(std::forward<Storage>(r)._Val);
+        else _Destroy();
+    }
+};
+
+// When T is trivially copyable, optional_storage declares no special members of its own, so that optional<T> is
+// itself trivially copyable
+template<class T, bool Trivial = is_trivially_copyable<T>::value> struct optional_storage : optional_storage_base<T>
+{
+    using optional_storage_base<T>::optional_storage_base;
+    optional_storage() = default;
+};
+template<class T> struct optional_storage<T, false> : optional_storage_base<T>
+{
+    using optional_storage_base<T>::optional_storage_base;
+    optional_storage() = default;
+    optional_storage(const optional_storage & r) : optional_storage_base<T>() { this->_Construct_from(r); }
+    optional_storage(optional_storage && r) noexcept(is_nothrow_move_constructible<T>::value) : optional_storage_base<T>() { this->_Construct_from(std::move(r)); }
+    optional_storage & operator=(const optional_storage & r) { this->_Assign_from(r); return *this; }
+    optional_storage & operator=(optional_storage && r) noexcept(is_nothrow_move_assignable<T>::value && is_nothrow_move_constructible<T>::value) { this->_Assign_from(std::move(r)); return *this; }
+};
+
+} // namespace std::_Early17
+
+template<class T> class optional : _Early17::optional_storage<T>
 {
 public:
-    variant<monostate, T> _Value;
+    typedef T value_type;
 
     ////////////////////////////////////////////////////////////////////////////////
     // (constructor) - http://en.cppreference.com/w/cpp/utility/optional/optional //
@@ -61,10 +133,11 @@ public:
     constexpr optional(nullopt_t) {} // (1)
     optional(const optional & other) = default; // (2)
     optional(optional && other) = default; // (3)
-    constexpr optional(const T & value) : _Value(value) {} // (4)
-    constexpr optional(T && value) : _Value(move(value)) {} // (5)
-    template<class... Args> constexpr explicit optional(in_place_t, Args&&... args) : _Value(in_place<1>, std::forward<Args>(args)...) {} // (6)
-    template<class U, class... Args> constexpr explicit optional(in_place_t, initializer_list<U> ilist, Args&&... args) : _Value(in_place<1>, ilist, std::forward<Args>(args)...) {} // (7)
+    constexpr optional(const T & value) : _Early17::optional_storage<T>(in_place, value) {} // (4)
+    constexpr optional(T && value) : _Early17::optional_storage<T>(in_place, std::move(value)) {} // (5)
+    template<class... Args> constexpr explicit optional(in_place_t, Args&&... args) : _Early17::optional_storage<T>(in_place, std::forward<Args>(args)...) {} // (6)
+    template<class U, class... Args> constexpr explicit optional(in_place_t, initializer_list<U> ilist, Args&&... args) : _Early17::optional_storage<T>(in_place, ilist, std::forward<Args>(args)...) {} // (7)
+    template<class F> explicit optional(in_place_from_t, F && f) : _Early17::optional_storage<T>(in_place_from, std::forward<F>(f)) {} // (extension)
 
     //////////////////////////////////////////////////////////////////////////////////
     // (destructor) - http://en.cppreference.com/w/cpp/utility/optional/%7Eoptional //
@@ -76,101 +149,246 @@ public:
     // operator= - http://en.cppreference.com/w/cpp/utility/optional/operator%3D //
     ///////////////////////////////////////////////////////////////////////////////
 
-    optional& operator= (std::nullopt_t) { _Value = monostate{}; return *this; } // (1)
+    optional& operator= (std::nullopt_t) { this->_Destroy(); return *this; } // (1)
     optional& operator= (const optional& other) = default; // (2)
     optional& operator= (optional&& other) = default; // (3)
-    template<class U> optional& operator=(U&& value) { _Value = std::forward<U>(value); return *this; } // (4)
+    template<class U, class = enable_if_t<!is_same<decay_t<U>, optional>::value>> optional& operator=(U&& value) // (4)
+    {
+        if(this->_Has_value) this->_Val = std::forward<U>(value);
+        else this->_Construct(std::forward<U>(value));
+        return *this;
+    }
 
     ////////////////////////////////////////////////////////////////////////////////
     // operator->,* - http://en.cppreference.com/w/cpp/utility/optional/operator* //
     ////////////////////////////////////////////////////////////////////////////////
 
-    constexpr const T* operator->() const { return reinterpret_cast<const T *>(&_Value._Storage); } // (1)
-    T* operator->() { return reinterpret_cast<T *>(&_Value._Storage); } // (1)
-    constexpr const T& operator*() const& { return reinterpret_cast<const T &>(_Value._Storage); } // (2)
-    T& operator*() & { return reinterpret_cast<T &>(_Value._Storage); } // (2)
-    constexpr const T&& operator*() const&& { return reinterpret_cast<const T &&>(_Value._Storage); } // (2)
-    T&& operator*() && { return reinterpret_cast<T &&>(_Value._Storage); } // (2)
+    constexpr const T* operator->() const { return &this->_Val; } // (1)
+    T* operator->() { return &this->_Val; } // (1)
+    constexpr const T& operator*() const& { return this->_Val; } // (2)
+    T& operator*() & { return this->_Val; } // (2)
+    constexpr const T&& operator*() const&& { return std::move(this->_Val); } // (2)
+    T&& operator*() && { return std::move(this->_Val); } // (2)
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // operator bool, has_value - http://en.cppreference.com/w/cpp/utility/optional/operator_bool //
     ////////////////////////////////////////////////////////////////////////////////////////////////
 
-    constexpr explicit operator bool() const { return _Value.index() == 1; }
-    constexpr bool has_value() const { return _Value.index() == 1; }
+    constexpr explicit operator bool() const { return this->_Has_value; }
+    constexpr bool has_value() const { return this->_Has_value; }
 
     /////////////////////////////////////////////////////////////////////
     // value - http://en.cppreference.com/w/cpp/utility/optional/value //
     /////////////////////////////////////////////////////////////////////
 
-    T& value() & { if(!has_value()) throw bad_optional_access{}; return std::get<1>(_Value); } // (1)
-    constexpr const T & value() const & { if(!has_value()) throw bad_optional_access{}; return std::get<1>(_Value); } // (1)
-    T&& value() && { if(!has_value()) throw bad_optional_access{}; return std::get<1>(std::move(_Value)); } // (2)
-    constexpr const T&& value() const && { if(!has_value()) throw bad_optional_access{}; return std::get<1>(std::move(_Value)); } // (2)
+    T& value() & { if(!this->_Has_value) throw bad_optional_access{}; return this->_Val; } // (1)
+    constexpr const T & value() const & { if(!this->_Has_value) throw bad_optional_access{}; return this->_Val; } // (1)
+    T&& value() && { if(!this->_Has_value) throw bad_optional_access{}; return std::move(this->_Val); } // (2)
+    constexpr const T&& value() const && { if(!this->_Has_value) throw bad_optional_access{}; return std::move(this->_Val); } // (2)
 
     ///////////////////////////////////////////////////////////////////////////
     // value_or - http://en.cppreference.com/w/cpp/utility/optional/value_or //
     ///////////////////////////////////////////////////////////////////////////
 
-    template<class U> constexpr T value_or(U && default_value ) const & { return has_value() ? value() : default_value; }
-    template<class U> T value_or(U && default_value ) && { return has_value() ? std::move(value()) : default_value; }
+    template<class U> constexpr T value_or(U && default_value ) const & { return this->_Has_value ? this->_Val : static_cast<T>(std::forward<U>(default_value)); }
+    template<class U> T value_or(U && default_value ) && { return this->_Has_value ? std::move(this->_Val) : static_cast<T>(std::forward<U>(default_value)); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // value_or_else - value, or a default computed on demand (not part of C++17) //
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // f() is only called if the optional is empty, so an expensive default costs nothing when a value is present
+    template<class F> T value_or_else(F && f) const & { if(this->_Has_value) return this->_Val; return std::forward<F>(f)(); }
+    template<class F> T value_or_else(F && f) && { if(this->_Has_value) return std::move(this->_Val); return std::forward<F>(f)(); }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // and_then - http://en.cppreference.com/w/cpp/utility/optional/and_then //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // f(value) must return an optional. If the optional is empty, an empty one is returned without calling f.
+    template<class F> auto and_then(F && f) & { return _And_then(std::forward<F>(f), this->_Val); }
+    template<class F> auto and_then(F && f) const & { return _And_then(std::forward<F>(f), this->_Val); }
+    template<class F> auto and_then(F && f) && { return _And_then(std::forward<F>(f), std::move(this->_Val)); }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // transform - http://en.cppreference.com/w/cpp/utility/optional/transform //
+    /////////////////////////////////////////////////////////////////////////////
+
+    // Wrap f(value) in an optional, constructing it directly in the result's storage
+    template<class F> auto transform(F && f) & { return _Transform(std::forward<F>(f), this->_Val); }
+    template<class F> auto transform(F && f) const & { return _Transform(std::forward<F>(f), this->_Val); }
+    template<class F> auto transform(F && f) && { return _Transform(std::forward<F>(f), std::move(this->_Val)); }
+
+    /////////////////////////////////////////////////////////////////////////
+    // or_else - http://en.cppreference.com/w/cpp/utility/optional/or_else //
+    /////////////////////////////////////////////////////////////////////////
+
+    // f() must return an optional<T>, and is only called if the optional is empty
+    template<class F> optional or_else(F && f) const & { _Check_or_else<F>(); if(this->_Has_value) return *this; return std::forward<F>(f)(); }
+    template<class F> optional or_else(F && f) && { _Check_or_else<F>(); if(this->_Has_value) return std::move(*this); return std::forward<F>(f)(); }
 
     ///////////////////////////////////////////////////////////////////
     // swap - http://en.cppreference.com/w/cpp/utility/optional/swap //
     ///////////////////////////////////////////////////////////////////
 
-    void swap(optional & other) { _Value.swap(other._Value); }
+    void swap(optional & other)
+    {
+        using std::swap;
+        if(this->_Has_value && other._Has_value) swap(this->_Val, other._Val);
+        else if(this->_Has_value) { other._Construct(std::move(this->_Val)); this->_Destroy(); }
+        else if(other._Has_value) { this->_Construct(std::move(other._Val)); other._Destroy(); }
+    }
 
     /////////////////////////////////////////////////////////////////////
     // reset - http://en.cppreference.com/w/cpp/utility/optional/reset //
     /////////////////////////////////////////////////////////////////////
 
-    void reset() { _Value = monostate{}; }
+    void reset() { this->_Destroy(); }
 
     /////////////////////////////////////////////////////////////////////////
     // emplace - http://en.cppreference.com/w/cpp/utility/optional/emplace //
     /////////////////////////////////////////////////////////////////////////
 
-    template<class... Args> void emplace(Args &&... args) { _Value.emplace(in_place<1>, std::forward<Args>(args)...); }
-    template<class U, class... Args> void emplace(initializer_list<U> ilist, Args&&... args) { _Value.emplace(in_place<1>, ilist, std::forward<Args>(args)...); }
+    template<class... Args> T & emplace(Args &&... args) { this->_Destroy(); this->_Construct(std::forward<Args>(args)...); return this->_Val; }
+    template<class U, class... Args> T & emplace(initializer_list<U> ilist, Args&&... args) { this->_Destroy(); this->_Construct(ilist, std::forward<Args>(args)...); return this->_Val; }
+
+    // Destroy the current value, then construct the new value directly from the prvalue returned by f(). As with
+    // emplace, f must not refer to the current value, and the optional is left empty if f() throws.
+    template<class F> T & emplace_from(F && f) { this->_Destroy(); this->_Construct_from_result(std::forward<F>(f)); return this->_Val; } // (extension)
+
+private:
+    // V is the value of *this, forwarded with the value category of *this, and is only accessed if there is a value
+    template<class F, class V> auto _And_then(F && f, V && v) const
+    {
+        typedef decay_t<decltype(std::forward<F>(f)(std::forward<V>(v)))> R;
+        static_assert(_Early17::is_optional<R>::value, "and_then requires f to return an optional");
+        if(this->_Has_value) return std::forward<F>(f)(std::forward<V>(v));
+        return R{};
+    }
+    template<class F, class V> auto _Transform(F && f, V && v) const
+    {
+        typedef remove_cv_t<remove_reference_t<decltype(std::forward<F>(f)(std::forward<V>(v)))>> U;
+        if(this->_Has_value) return optional<U>(in_place_from, [&]() -> U { return std::forward<F>(f)(std::forward<V>(v)); });
+        return optional<U>{};
+    }
+    template<class F> static void _Check_or_else() { static_assert(is_same<decay_t<decltype(std::declval<F>()())>, optional>::value, "or_else requires f to return an optional of the same type"); }
+};
+
+namespace _Early17 {
+
+// transform constructs an optional<R> from the result of f directly, or rebinds an optional<R &> to it, when f
+// returns an lvalue reference. An rvalue reference result is moved into an optional of the referenced type.
+template<class R> using optional_transform_t = conditional_t<is_lvalue_reference<R>::value, R, remove_cv_t<remove_reference_t<R>>>;
+template<class R> struct optional_transform
+{
+    template<class F, class X> static optional<R> apply(F && f, X && x) { return optional<R>(in_place_from, [&]() -> R { return std::forward<F>(f)(std::forward<X>(x)); }); }
+};
+template<class R> struct optional_transform<R &>
+{
+    template<class F, class X> static optional<R &> apply(F && f, X && x) { return optional<R &>(std::forward<F>(f)(std::forward<X>(x))); }
+};
+
+} // namespace std::_Early17
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// optional<T &> - optional reference, which rebinds on assignment (not part of C++17) //
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// optional<T &> holds a single pointer, which is null when it is disengaged, so it is trivially copyable and the size
+// of a pointer. Like a pointer, and unlike a T &, assigning a reference to it rebinds it rather than assigning through
+// to the referenced object, and copying it copies the reference. It cannot be bound to a temporary. It allows lookup
+// functions to return a reference to a value they found without copying it, or a disengaged optional if they did not.
+template<class T> class optional<T &>
+{
+    T * _Ptr;
+public:
+    typedef T value_type;
+
+    constexpr optional() noexcept : _Ptr{nullptr} {}
+    constexpr optional(nullopt_t) noexcept : _Ptr{nullptr} {}
+    optional(const optional & other) = default;
+    constexpr optional(T & ref) noexcept : _Ptr{&ref} {}
+    optional(T && ref) = delete;
+    template<class U, class = enable_if_t<is_convertible<U *, T *>::value>> constexpr optional(const optional<U &> & other) noexcept : _Ptr{other.has_value() ? &*other : nullptr} {}
+
+    optional & operator=(nullopt_t) noexcept { _Ptr = nullptr; return *this; }
+    optional & operator=(const optional & other) = default;
+    optional & operator=(T & ref) noexcept { _Ptr = &ref; return *this; }
+    optional & operator=(T && ref) = delete;
+
+    T & emplace(T & ref) noexcept { _Ptr = &ref; return ref; }
+    void reset() noexcept { _Ptr = nullptr; }
+    void swap(optional & other) noexcept { std::swap(_Ptr, other._Ptr); }
+
+    constexpr T * operator->() const noexcept { return _Ptr; }
+    constexpr T & operator*() const noexcept { return *_Ptr; }
+    constexpr explicit operator bool() const noexcept { return _Ptr != nullptr; }
+    constexpr bool has_value() const noexcept { return _Ptr != nullptr; }
+    T & value() const { if(!_Ptr) throw bad_optional_access{}; return *_Ptr; }
+
+    // value_or returns the referenced object itself when the default is also an lvalue of a type T & can bind to, and
+    // a copy of one or the other otherwise
+    constexpr T & value_or(T & default_value) const noexcept { return _Ptr ? *_Ptr : default_value; }
+    template<class U, class = enable_if_t<!(is_lvalue_reference<U>::value && is_convertible<U, T &>::value)>> constexpr remove_cv_t<T> value_or(U && default_value) const { return _Ptr ? *_Ptr : static_cast<remove_cv_t<T>>(std::forward<U>(default_value)); }
+
+    // The monadic operations pass the referenced object to f as a T &, and transform returns an optional<U &> when f
+    // returns a U &, so that a chain of lookups never copies the values it passes through, and an optional<U> otherwise
+    template<class F> auto and_then(F && f) const -> remove_cv_t<remove_reference_t<decltype(std::forward<F>(f)(*_Ptr))>>
+    {
+        if(_Ptr) return std::forward<F>(f)(*_Ptr);
+        return remove_cv_t<remove_reference_t<decltype(std::forward<F>(f)(*_Ptr))>>{};
+    }
+    template<class F> auto transform(F && f) const -> optional<_Early17::optional_transform_t<decltype(std::forward<F>(f)(*_Ptr))>>
+    {
+        typedef _Early17::optional_transform_t<decltype(std::forward<F>(f)(*_Ptr))> result_type;
+        if(_Ptr) return _Early17::optional_transform<result_type>::apply(std::forward<F>(f), *_Ptr);
+        return nullopt;
+    }
+    template<class F> optional or_else(F && f) const { return _Ptr ? *this : std::forward<F>(f)(); }
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // operator==, !=, <, <=, >, >= - http://en.cppreference.com/w/cpp/utility/optional/operator_cmp //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-template<class T> constexpr bool operator==(const optional<T> & lhs, const optional<T> & rhs) { return lhs._Value == rhs._Value; } // (1)
-template<class T> constexpr bool operator!=(const optional<T> & lhs, const optional<T> & rhs) { return lhs._Value != rhs._Value; } // (2)
-template<class T> constexpr bool operator< (const optional<T> & lhs, const optional<T> & rhs) { return lhs._Value <  rhs._Value; } // (3)
-template<class T> constexpr bool operator<=(const optional<T> & lhs, const optional<T> & rhs) { return lhs._Value <= rhs._Value; } // (4)
-template<class T> constexpr bool operator> (const optional<T> & lhs, const optional<T> & rhs) { return lhs._Value >  rhs._Value; } // (5)
-template<class T> constexpr bool operator>=(const optional<T> & lhs, const optional<T> & rhs) { return lhs._Value >= rhs._Value; } // (6)
+template<class T> constexpr bool operator==(const optional<T> & lhs, const optional<T> & rhs) { return lhs.has_value() != rhs.has_value() ? false : !lhs.has_value() ? true : *lhs == *rhs; } // (1)
+template<class T> constexpr bool operator!=(const optional<T> & lhs, const optional<T> & rhs) { return lhs.has_value() != rhs.has_value() ? true : !lhs.has_value() ? false : *lhs != *rhs; } // (2)
+template<class T> constexpr bool operator< (const optional<T> & lhs, const optional<T> & rhs) { return !rhs.has_value() ? false : !lhs.has_value() ? true : *lhs < *rhs; } // (3)
+template<class T> constexpr bool operator<=(const optional<T> & lhs, const optional<T> & rhs) { return !lhs.has_value() ? true : !rhs.has_value() ? false : *lhs <= *rhs; } // (4)
+template<class T> constexpr bool operator> (const optional<T> & lhs, const optional<T> & rhs) { return !lhs.has_value() ? false : !rhs.has_value() ? true : *lhs > *rhs; } // (5)
+template<class T> constexpr bool operator>=(const optional<T> & lhs, const optional<T> & rhs) { return !rhs.has_value() ? true : !lhs.has_value() ? false : *lhs >= *rhs; } // (6)
 	
-template<class T> constexpr bool operator==(const optional<T>& opt, std::nullopt_t) { return opt == optional<T>{nullopt}; }  // (7)
-template<class T> constexpr bool operator==(std::nullopt_t, const optional<T>& opt) { return optional<T>{nullopt} == opt; } // (8)
-template<class T> constexpr bool operator!=(const optional<T>& opt, std::nullopt_t) { return opt != optional<T>{nullopt}; } // (9)
-template<class T> constexpr bool operator!=(std::nullopt_t, const optional<T>& opt) { return optional<T>{nullopt} != opt; } // (10)
-template<class T> constexpr bool operator< (const optional<T>& opt, std::nullopt_t) { return opt <  optional<T>{nullopt}; } // (11)
-template<class T> constexpr bool operator< (std::nullopt_t, const optional<T>& opt) { return optional<T>{nullopt} <  opt; } // (12)
-template<class T> constexpr bool operator<=(const optional<T>& opt, std::nullopt_t) { return opt <= optional<T>{nullopt}; } // (13)
-template<class T> constexpr bool operator<=(std::nullopt_t, const optional<T>& opt) { return optional<T>{nullopt} <= opt; } // (14)
-template<class T> constexpr bool operator> (const optional<T>& opt, std::nullopt_t) { return opt >  optional<T>{nullopt}; } // (15)
-template<class T> constexpr bool operator> (std::nullopt_t, const optional<T>& opt) { return optional<T>{nullopt} >  opt; } // (16)
-template<class T> constexpr bool operator>=(const optional<T>& opt, std::nullopt_t) { return opt >= optional<T>{nullopt}; } // (17)
-template<class T> constexpr bool operator>=(std::nullopt_t, const optional<T>& opt) { return optional<T>{nullopt} >= opt; } // (18)
-
-template<class T> constexpr bool operator==(const optional<T>& opt, const T& value) { return opt == optional<T>{value}; } // (19)
-template<class T> constexpr bool operator==(const T& value, const optional<T>& opt) { return optional<T>{value} == opt; } // (20)
-template<class T> constexpr bool operator!=(const optional<T>& opt, const T& value) { return opt != optional<T>{value}; } // (21)
-template<class T> constexpr bool operator!=(const T& value, const optional<T>& opt) { return optional<T>{value} != opt; } // (22)
-template<class T> constexpr bool operator< (const optional<T>& opt, const T& value) { return opt <  optional<T>{value}; } // (23)
-template<class T> constexpr bool operator< (const T& value, const optional<T>& opt) { return optional<T>{value} <  opt; } // (24)
-template<class T> constexpr bool operator<=(const optional<T>& opt, const T& value) { return opt <= optional<T>{value}; } // (25)
-template<class T> constexpr bool operator<=(const T& value, const optional<T>& opt) { return optional<T>{value} <= opt; } // (26)
-template<class T> constexpr bool operator> (const optional<T>& opt, const T& value) { return opt >  optional<T>{value}; } // (27)
-template<class T> constexpr bool operator> (const T& value, const optional<T>& opt) { return optional<T>{value} >  opt; } // (28)
-template<class T> constexpr bool operator>=(const optional<T>& opt, const T& value) { return opt >= optional<T>{value}; } // (29)
-template<class T> constexpr bool operator>=(const T& value, const optional<T>& opt) { return optional<T>{value} >= opt; } // (30)
+template<class T> constexpr bool operator==(const optional<T>& opt, std::nullopt_t) { return !opt; } // (7)
+template<class T> constexpr bool operator==(std::nullopt_t, const optional<T>& opt) { return !opt; } // (8)
+template<class T> constexpr bool operator!=(const optional<T>& opt, std::nullopt_t) { return bool(opt); } // (9)
+template<class T> constexpr bool operator!=(std::nullopt_t, const optional<T>& opt) { return bool(opt); } // (10)
+template<class T> constexpr bool operator< (const optional<T>&, std::nullopt_t) { return false; } // (11)
+template<class T> constexpr bool operator< (std::nullopt_t, const optional<T>& opt) { return bool(opt); } // (12)
+template<class T> constexpr bool operator<=(const optional<T>& opt, std::nullopt_t) { return !opt; } // (13)
+template<class T> constexpr bool operator<=(std::nullopt_t, const optional<T>&) { return true; } // (14)
+template<class T> constexpr bool operator> (const optional<T>& opt, std::nullopt_t) { return bool(opt); } // (15)
+template<class T> constexpr bool operator> (std::nullopt_t, const optional<T>&) { return false; } // (16)
+template<class T> constexpr bool operator>=(const optional<T>&, std::nullopt_t) { return true; } // (17)
+template<class T> constexpr bool operator>=(std::nullopt_t, const optional<T>& opt) { return !opt; } // (18)
+
+// As in C++17, the value may be of any type U which T can be compared with, such as a string_view for an optional
+// string, and is compared with the contained value directly, without constructing an optional<T> from it
+namespace _Early17 {
+template<class U> using enable_if_not_optional_t = enable_if_t<!is_optional<U>::value && !is_same<U, nullopt_t>::value, bool>;
+} // namespace std::_Early17
+
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator==(const optional<T>& opt, const U& value) { return opt ? *opt == value : false; } // (19)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator==(const U& value, const optional<T>& opt) { return opt ? value == *opt : false; } // (20)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator!=(const optional<T>& opt, const U& value) { return opt ? *opt != value : true; } // (21)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator!=(const U& value, const optional<T>& opt) { return opt ? value != *opt : true; } // (22)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator< (const optional<T>& opt, const U& value) { return opt ? *opt <  value : true; } // (23)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator< (const U& value, const optional<T>& opt) { return opt ? value <  *opt : false; } // (24)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator<=(const optional<T>& opt, const U& value) { return opt ? *opt <= value : true; } // (25)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator<=(const U& value, const optional<T>& opt) { return opt ? value <= *opt : false; } // (26)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator> (const optional<T>& opt, const U& value) { return opt ? *opt >  value : false; } // (27)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator> (const U& value, const optional<T>& opt) { return opt ? value >  *opt : true; } // (28)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator>=(const optional<T>& opt, const U& value) { return opt ? *opt >= value : false; } // (29)
+template<class T, class U, _Early17::enable_if_not_optional_t<U> = true> constexpr bool operator>=(const U& value, const optional<T>& opt) { return opt ? value >= *opt : true; } // (30)
 
 /////////////////////////////////////////////////////////////////////////////////////
 // make_optional - http://en.cppreference.com/w/cpp/utility/optional/make_optional //
@@ -194,6 +412,10 @@ template<class T> struct hash<std::optional<T>>
 {
     size_t operator() (const std::optional<T> & key) const noexcept { return key ? std::hash<T>{}(*key) : 0; }
 };
+template<class T> struct hash<std::optional<T &>>
+{
+    size_t operator() (const std::optional<T &> & key) const noexcept { return key ? std::hash<remove_const_t<T>>{}(*key) : 0; }
+};
 
 } // namespace std
 
@@ -0,0 +1,228 @@
+// optional_aggregates.h provides summarize_engaged, which computes the count,
+// sum, minimum, maximum and mean of the engaged elements of a column of
+// optional numbers, treating the engaged flags as a mask rather than branching
+// on each of them. It is an extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_OPTIONAL_AGGREGATES
+#define VOCAB_TYPES_OPTIONAL_AGGREGATES
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "optional.h"
+#include "optional_array.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace vocab {
+
+// The count, sum, minimum and maximum of the engaged elements of a column, of which the minimum and maximum are empty
+// if no element is engaged. The sum has type T, and so can overflow where T is an integer type.
+template<class T> struct engaged_summary
+{
+    size_t count;
+    T sum;
+    std::optional<T> min, max;
+
+    std::optional<double> mean() const { return count ? std::optional<double>{static_cast<double>(sum) / count} : std::nullopt; }
+};
+
+namespace detail {
+
+template<class T> constexpr T summary_high() { return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max(); }
+template<class T> constexpr T summary_low() { return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest(); }
+
+// Accumulates elements one at a time, selecting rather than branching on whether each is engaged. A kernel which can
+// consume elements several at a time overrides add_optionals and add_masked, which return how many elements they
+// consumed, and result, which folds its lanes into the scalar totals.
+template<class T> struct scalar_summary
+{
+    size_t count = 0;
+    T sum = 0, lo = summary_high<T>(), hi = summary_low<T>();
+
+    void add(T x, bool engaged) noexcept
+    {
+        count += engaged;
+        sum += engaged ? x : T(0);
+        lo = engaged && x < lo ? x : lo;
+        hi = engaged && hi < x ? x : hi;
+    }
+    size_t add_optionals(const std::optional<T> *, size_t) noexcept { return 0; }
+    size_t add_masked(const T *, uint64_t, size_t) noexcept { return 0; }
+    engaged_summary<T> result() const
+    {
+        engaged_summary<T> r {count, sum, std::nullopt, std::nullopt};
+        if(count) { r.min = lo; r.max = hi; }
+        return r;
+    }
+};
+template<class T> struct summary_kernel : scalar_summary<T> {};
+
+#ifdef __AVX2__
+struct avx2_f64
+{
+    typedef __m256d reg;
+    static reg from_bits(__m256i x) noexcept { return _mm256_castsi256_pd(x); }
+    static reg load(const double * p) noexcept { return _mm256_loadu_pd(p); }
+    static reg splat(double x) noexcept { return _mm256_set1_pd(x); }
+    static void store(double * p, reg x) noexcept { _mm256_storeu_pd(p, x); }
+    static reg add(reg a, reg b) noexcept { return _mm256_add_pd(a, b); }
+    static reg masked(reg x, __m256i m) noexcept { return _mm256_and_pd(x, _mm256_castsi256_pd(m)); }
+    static reg select(__m256i m, reg a, reg b) noexcept { return _mm256_blendv_pd(b, a, _mm256_castsi256_pd(m)); }
+    static reg min(reg a, reg b) noexcept { return _mm256_min_pd(a, b); }
+    static reg max(reg a, reg b) noexcept { return _mm256_max_pd(a, b); }
+};
+
+struct avx2_i64
+{
+    typedef __m256i reg;
+    static reg from_bits(__m256i x) noexcept { return x; }
+    static reg load(const int64_t * p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static reg splat(int64_t x) noexcept { return _mm256_set1_epi64x(x); }
+    static void store(int64_t * p, reg x) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), x); }
+    static reg add(reg a, reg b) noexcept { return _mm256_add_epi64(a, b); }
+    static reg masked(reg x, __m256i m) noexcept { return _mm256_and_si256(x, m); }
+    static reg select(__m256i m, reg a, reg b) noexcept { return _mm256_blendv_epi8(b, a, m); }
+    static reg min(reg a, reg b) noexcept { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+    static reg max(reg a, reg b) noexcept { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a)); }
+};
+
+// Accumulates four elements at a time, in lanes which are folded together only once, by result()
+template<class T, class Lanes> struct avx2_summary : scalar_summary<T>
+{
+    typedef typename Lanes::reg reg;
+    reg sum4 = Lanes::splat(0), lo4 = Lanes::splat(summary_high<T>()), hi4 = Lanes::splat(summary_low<T>());
+    __m256i count4 = _mm256_setzero_si256();
+
+    // engaged holds all ones in the lanes of engaged elements, and zeros elsewhere
+    void add4(reg x, __m256i engaged) noexcept
+    {
+        sum4 = Lanes::add(sum4, Lanes::masked(x, engaged));
+        lo4 = Lanes::min(lo4, Lanes::select(engaged, x, lo4));
+        hi4 = Lanes::max(hi4, Lanes::select(engaged, x, hi4));
+        count4 = _mm256_sub_epi64(count4, engaged);
+    }
+
+    // A std::optional<T> stores its value followed by its engaged flag, in the low byte of the next eight, so two loads
+    // of two optionals each deinterleave into four values and four flags
+    size_t add_optionals(const std::optional<T> * p, size_t n) noexcept
+    {
+        static_assert(sizeof(std::optional<T>) == 2 * sizeof(T), "std::optional<T> is expected to hold a value and a flag in two eight byte words");
+        const __m256i flag_byte = _mm256_set1_epi64x(0xFF), zero = _mm256_setzero_si256(), ones = _mm256_set1_epi64x(-1);
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i + 2));
+            const __m256i empty = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_unpackhi_epi64(a, b), flag_byte), zero);
+            add4(Lanes::from_bits(_mm256_unpacklo_epi64(a, b)), _mm256_xor_si256(empty, ones));
+        }
+        return i;
+    }
+
+    // Expand each group of four bits into four lane masks
+    size_t add_masked(const T * values, uint64_t bits, size_t n) noexcept
+    {
+        const __m256i lane_bits = _mm256_setr_epi64x(1, 2, 4, 8);
+        size_t i = 0;
+        for(; i + 4 <= n; i += 4, bits >>= 4)
+        {
+            const __m256i m = _mm256_and_si256(_mm256_set1_epi64x(static_cast<int64_t>(bits & 15)), lane_bits);
+            add4(Lanes::load(values + i), _mm256_cmpeq_epi64(m, lane_bits));
+        }
+        return i;
+    }
+
+    engaged_summary<T> result() const
+    {
+        T sum[4], lo[4], hi[4];
+        int64_t count[4];
+        Lanes::store(sum, sum4);
+        Lanes::store(lo, lo4);
+        Lanes::store(hi, hi4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(count), count4);
+        scalar_summary<T> r = *this;
+        for(int j=0; j<4; ++j)
+        {
+            r.count += static_cast<size_t>(count[j]);
+            r.sum += sum[j];
+            r.lo = std::min(r.lo, lo[j]);
+            r.hi = std::max(r.hi, hi[j]);
+        }
+        return r.result();
+    }
+};
+template<> struct summary_kernel<double> : avx2_summary<double, avx2_f64> {};
+template<> struct summary_kernel<int64_t> : avx2_summary<int64_t, avx2_i64> {};
+#endif
+
+} // namespace vocab::detail
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// summarize_engaged - count, sum, min, max and mean of the engaged elements of a column //
+///////////////////////////////////////////////////////////////////////////////////////////
+
+// summarize_engaged accepts a column either as an array of std::optional<T>, or as an array of values and a bitmap,
+// in which bit i % 64 of word i / 64 is set if element i is engaged, as stored by optional_array. Neither branches on
+// whether individual elements are engaged: each element is added to the totals under a mask of its engaged flag, and
+// the bitmap form skips 64 empty elements at a time. When compiled with AVX2 enabled, columns of double and int64_t
+// are summarized four elements at a time, and all other arithmetic types one at a time. The minimum and maximum of a
+// column which contains NaN values are unspecified.
+template<class T> engaged_summary<T> summarize_engaged(const std::optional<T> * elements, size_t n)
+{
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "summarize_engaged requires an arithmetic element type");
+    detail::summary_kernel<T> kernel;
+    for(size_t i = kernel.add_optionals(elements, n); i<n; ++i) kernel.add(elements[i].value_or(T(0)), elements[i].has_value());
+    return kernel.result();
+}
+
+template<class T> engaged_summary<T> summarize_engaged(const T * values, const uint64_t * bitmap, size_t n)
+{
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "summarize_engaged requires an arithmetic element type");
+    detail::summary_kernel<T> kernel;
+    for(size_t base=0; base<n; base+=64)
+    {
+        const uint64_t bits = bitmap[base >> 6];
+        if(!bits) continue;
+        const size_t count = std::min<size_t>(64, n - base);
+        for(size_t j = kernel.add_masked(values + base, bits, count); j<count; ++j) kernel.add(values[base + j], (bits >> j) & 1);
+    }
+    return kernel.result();
+}
+
+template<class T> engaged_summary<T> summarize_engaged(const std::vector<std::optional<T>> & elements) { return summarize_engaged(elements.data(), elements.size()); }
+template<class T> engaged_summary<T> summarize_engaged(const optional_array<T> & elements) { return summarize_engaged(elements.values(), elements.bitmap(), elements.size()); }
+
+} // namespace vocab
+
+#endif
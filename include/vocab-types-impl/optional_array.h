@@ -0,0 +1,160 @@
+// optional_array.h provides optional_array, a growable array of optional
+// values stored as a dense array of values and a separate validity bitmap,
+// with one bit per element. It is an extension to vocab-types, and its
+// permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_OPTIONAL_ARRAY
+#define VOCAB_TYPES_OPTIONAL_ARRAY
+
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "optional.h"
+#include "bit_ops.h"
+
+namespace vocab {
+
+//////////////////////////////////////////////////////////////////////////////////
+// optional_array - columnar array of optionals, with a one bit validity bitmap //
+//////////////////////////////////////////////////////////////////////////////////
+
+// An optional_array<T> holds the same elements as a std::vector<std::optional<T>>, but in the layout of an Arrow
+// column: the values are stored contiguously in a std::vector<T>, and whether each element is engaged is stored as
+// one bit in an array of 64 bit words, so that an element costs sizeof(T) bytes plus one bit, rather than sizeof(T)
+// plus the discriminator and its padding. The value slot of an empty element holds an unspecified value of T, which
+// is why T must be default constructible.
+//
+// operator[] returns a proxy reference, which behaves like a std::optional<T &> to the element and assigns through
+// to it. count() sums the popcounts of the bitmap words, and for_each_engaged visits engaged elements a word of the
+// bitmap at a time, skipping 64 empty elements with a single test, so that scans of sparse columns cost little
+// more than reading their bitmaps.
+template<class T> class optional_array
+{
+    static_assert(!std::is_same<T, bool>::value, "optional_array<bool> is not supported, as std::vector<bool> does not store its values contiguously");
+    std::vector<T> _Values;
+    std::vector<uint64_t> _Bits;
+
+    void _Set(size_t i) noexcept { _Bits[i >> 6] |= uint64_t(1) << (i & 63); }
+    void _Clear(size_t i) noexcept { _Bits[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+    void _Resize_bits(size_t n)
+    {
+        _Bits.resize((n + 63) / 64, 0);
+        if(n & 63) _Bits.back() &= detail::low_bits64(n & 63);
+    }
+public:
+    typedef T value_type;
+    typedef std::optional<const T &> const_reference;
+
+    // A proxy for an element, which reads like a std::optional<T &> to it, and assigns through to it
+    class reference
+    {
+        friend class optional_array;
+        optional_array * _Array;
+        size_t _Index;
+        reference(optional_array * array, size_t index) noexcept : _Array{array}, _Index{index} {}
+    public:
+        reference(const reference &) = default;
+
+        bool has_value() const noexcept { return _Array->has_value(_Index); }
+        explicit operator bool() const noexcept { return _Array->has_value(_Index); }
+        T & operator*() const noexcept { return _Array->_Values[_Index]; }
+        T * operator->() const noexcept { return &_Array->_Values[_Index]; }
+        T & value() const { if(!has_value()) throw std::bad_optional_access{}; return _Array->_Values[_Index]; }
+        template<class U> T value_or(U && default_value) const { return has_value() ? _Array->_Values[_Index] : static_cast<T>(std::forward<U>(default_value)); }
+
+        reference & operator=(const T & value) { _Array->_Values[_Index] = value; _Array->_Set(_Index); return *this; }
+        reference & operator=(T && value) { _Array->_Values[_Index] = std::move(value); _Array->_Set(_Index); return *this; }
+        reference & operator=(std::nullopt_t) noexcept { reset(); return *this; }
+        reference & operator=(const std::optional<T> & value) { if(value) *this = *value; else reset(); return *this; }
+        reference & operator=(const reference & r) { if(r.has_value()) *this = *r; else reset(); return *this; }
+        void reset() noexcept { _Array->_Clear(_Index); }
+
+        operator std::optional<T &>() const noexcept { return has_value() ? std::optional<T &>{_Array->_Values[_Index]} : std::nullopt; }
+        operator std::optional<T>() const { return has_value() ? std::optional<T>{_Array->_Values[_Index]} : std::nullopt; }
+    };
+
+    optional_array() = default;
+    explicit optional_array(size_t count) : _Values(count), _Bits((count + 63) / 64, 0) {}
+    optional_array(std::initializer_list<std::optional<T>> ilist) { reserve(ilist.size()); for(auto & x : ilist) push_back(x); }
+
+    size_t size() const noexcept { return _Values.size(); }
+    bool empty() const noexcept { return _Values.empty(); }
+    void reserve(size_t count) { _Values.reserve(count); _Bits.reserve((count + 63) / 64); }
+    void clear() noexcept { _Values.clear(); _Bits.clear(); }
+
+    // Elements added by growing the array are empty
+    void resize(size_t count) { _Values.resize(count); _Resize_bits(count); }
+
+    void push_back(std::nullopt_t) { _Values.emplace_back(); _Resize_bits(_Values.size()); }
+    void push_back(const T & value) { _Values.push_back(value); _Resize_bits(_Values.size()); _Set(_Values.size() - 1); }
+    void push_back(T && value) { _Values.push_back(std::move(value)); _Resize_bits(_Values.size()); _Set(_Values.size() - 1); }
+    void push_back(const std::optional<T> & value) { if(value) push_back(*value); else push_back(std::nullopt); }
+    template<class... Args> T & emplace_back(Args &&... args) { _Values.emplace_back(std::forward<Args>(args)...); _Resize_bits(_Values.size()); _Set(_Values.size() - 1); return _Values.back(); }
+    void pop_back() { _Values.pop_back(); _Resize_bits(_Values.size()); }
+
+    bool has_value(size_t i) const noexcept { return (_Bits[i >> 6] >> (i & 63)) & 1; }
+    reference operator[](size_t i) noexcept { return {this, i}; }
+    const_reference operator[](size_t i) const noexcept { return has_value(i) ? const_reference{_Values[i]} : std::nullopt; }
+
+    // The number of engaged elements
+    size_t count() const noexcept
+    {
+        size_t n = 0;
+        for(auto w : _Bits) n += detail::popcount64(w);
+        return n;
+    }
+
+    // Invoke f(index, value) for each engaged element, in order of index
+    template<class F> void for_each_engaged(F && f) { _For_each_engaged(*this, f); }
+    template<class F> void for_each_engaged(F && f) const { _For_each_engaged(*this, f); }
+
+    // The dense values and the validity bitmap, in which bit i % 64 of word i / 64 is set if element i is engaged, and
+    // the bits past size() are zero
+    T * values() noexcept { return _Values.data(); }
+    const T * values() const noexcept { return _Values.data(); }
+    const uint64_t * bitmap() const noexcept { return _Bits.data(); }
+    size_t bitmap_words() const noexcept { return _Bits.size(); }
+private:
+    template<class Array, class F> static void _For_each_engaged(Array & a, F & f)
+    {
+        for(size_t w=0; w<a._Bits.size(); ++w)
+        {
+            for(uint64_t bits = a._Bits[w]; bits; bits &= bits - 1)
+            {
+                const size_t i = w * 64 + detail::countr_zero64(bits);
+                f(i, a._Values[i]);
+            }
+        }
+    }
+};
+
+} // namespace vocab
+
+#endif
@@ -0,0 +1,163 @@
+// packed_optionals.h provides packed_optionals, a record of optional fields
+// which keeps the presence flags of all of its fields together in a single
+// word, and its payloads packed together in declaration order. It is an
+// extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_PACKED_OPTIONALS
+#define VOCAB_TYPES_PACKED_OPTIONALS
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "optional.h"
+#include "bit_ops.h"
+
+namespace vocab {
+
+namespace detail {
+
+constexpr size_t align_up(size_t offset, size_t alignment) { return (offset + alignment - 1) / alignment * alignment; }
+constexpr size_t max_of() { return 1; }
+constexpr size_t max_of(size_t a, size_t b) { return a > b ? a : b; }
+template<class... Rest> constexpr size_t max_of(size_t first, Rest... rest) { return max_of(first, max_of(rest...)); }
+constexpr bool all_true() { return true; }
+template<class... Rest> constexpr bool all_true(bool first, Rest... rest) { return first && all_true(rest...); }
+
+// The offset of field I, which follows field I-1 at the next multiple of its own alignment, as in a struct
+template<size_t I, class... Fields> struct packed_offset : std::integral_constant<size_t, align_up(packed_offset<I-1, Fields...>::value + sizeof(std::tuple_element_t<I-1, std::tuple<Fields...>>), alignof(std::tuple_element_t<I, std::tuple<Fields...>>))> {};
+template<class... Fields> struct packed_offset<0, Fields...> : std::integral_constant<size_t, 0> {};
+
+template<size_t N> using presence_word_t = std::conditional_t<(N <= 8), uint8_t, std::conditional_t<(N <= 16), uint16_t, std::conditional_t<(N <= 32), uint32_t, uint64_t>>>;
+
+} // namespace vocab::detail
+
+/////////////////////////////////////////////////////////////////////////////////////
+// packed_optionals - optional fields sharing one presence word, payloads in order //
+/////////////////////////////////////////////////////////////////////////////////////
+
+// A packed_optionals<Fields...> holds one optional value of each of Fields..., like a struct of std::optional
+// members, but stores the presence flags of all the fields as the bits of one unsigned word, the smallest which has a
+// bit for each field, followed by the payloads in declaration order, each at the next multiple of its alignment. A
+// record of thirty optional<int32_t> or optional<float> fields thus occupies 124 bytes rather than 240.
+//
+// The fields must be trivially copyable, and so is a packed_optionals, which can be serialized with a single memcpy.
+// The payload bytes of an absent field are always zero, so records which hold the same fields, with identical values,
+// have identical representations. operator== compares present fields with their own operator==, so records can still
+// compare equal while differing bytewise, as for +0.0 and -0.0, or a field type with padding bytes.
+// get<I>() returns a proxy which reads like a std::optional<T &> and assigns through to the field, and count() is a
+// single popcount of the presence word.
+template<class... Fields> class packed_optionals
+{
+    static_assert(sizeof...(Fields) >= 1 && sizeof...(Fields) <= 64, "packed_optionals supports between 1 and 64 fields");
+    static_assert(detail::all_true(std::is_trivially_copyable<Fields>::value...), "the fields of packed_optionals must be trivially copyable");
+public:
+    constexpr static size_t field_count = sizeof...(Fields);
+    template<size_t I> using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+    typedef detail::presence_word_t<sizeof...(Fields)> presence_type;
+    template<size_t I> using offset = detail::packed_offset<I, Fields...>;
+private:
+    // The presence word and the payloads share one byte array, so that no padding bytes lie outside of it
+    constexpr static size_t _Alignment = detail::max_of(alignof(presence_type), alignof(Fields)...);
+    constexpr static size_t _Payload_offset = detail::align_up(sizeof(presence_type), detail::max_of(alignof(Fields)...));
+    constexpr static size_t _Size = detail::align_up(_Payload_offset + offset<field_count - 1>::value + sizeof(field_type<field_count - 1>), _Alignment);
+
+    alignas(_Alignment) unsigned char _Bytes[_Size];
+
+    presence_type & _Present() noexcept { return reinterpret_cast<presence_type &>(_Bytes[0]); }
+    const presence_type & _Present() const noexcept { return reinterpret_cast<const presence_type &>(_Bytes[0]); }
+    template<size_t I> field_type<I> & _Field() noexcept { return reinterpret_cast<field_type<I> &>(_Bytes[_Payload_offset + offset<I>::value]); }
+    template<size_t I> const field_type<I> & _Field() const noexcept { return reinterpret_cast<const field_type<I> &>(_Bytes[_Payload_offset + offset<I>::value]); }
+    template<size_t I> void _Clear() noexcept { _Present() &= ~(presence_type(1) << I); std::memset(&_Field<I>(), 0, sizeof(field_type<I>)); }
+
+    template<size_t... I> void _Assign(std::index_sequence<I...>, const std::optional<Fields> &... values) { int expand[] = {(get<I>() = values, 0)...}; (void)expand; }
+    template<size_t... I> bool _Equal(const packed_optionals & r, std::index_sequence<I...>) const
+    {
+        bool equal = _Present() == r._Present();
+        int expand[] = {(equal = equal && (!has_value<I>() || _Field<I>() == r.template _Field<I>()), 0)...};
+        (void)expand;
+        return equal;
+    }
+public:
+    // A proxy for field I, which reads like a std::optional<T &> to it, and assigns through to it
+    template<size_t I> class reference
+    {
+        friend class packed_optionals;
+        typedef field_type<I> T;
+        packed_optionals * _Record;
+        explicit reference(packed_optionals * record) noexcept : _Record{record} {}
+    public:
+        reference(const reference &) = default;
+
+        bool has_value() const noexcept { return _Record->template has_value<I>(); }
+        explicit operator bool() const noexcept { return _Record->template has_value<I>(); }
+        T & operator*() const noexcept { return _Record->template _Field<I>(); }
+        T * operator->() const noexcept { return &_Record->template _Field<I>(); }
+        T & value() const { if(!has_value()) throw std::bad_optional_access{}; return _Record->template _Field<I>(); }
+        template<class U> T value_or(U && default_value) const { return has_value() ? _Record->template _Field<I>() : static_cast<T>(std::forward<U>(default_value)); }
+
+        reference & operator=(const T & value) noexcept { _Record->template _Field<I>() = value; _Record->_Present() |= presence_type(1) << I; return *this; }
+        reference & operator=(std::nullopt_t) noexcept { reset(); return *this; }
+        reference & operator=(const std::optional<T> & value) noexcept { if(value) *this = *value; else reset(); return *this; }
+        reference & operator=(const reference & r) noexcept { if(r.has_value()) *this = *r; else reset(); return *this; }
+        void reset() noexcept { _Record->template _Clear<I>(); }
+
+        operator std::optional<T &>() const noexcept { return has_value() ? std::optional<T &>{**this} : std::nullopt; }
+        operator std::optional<T>() const noexcept { return has_value() ? std::optional<T>{**this} : std::nullopt; }
+    };
+
+    packed_optionals() noexcept : _Bytes{} {}
+    packed_optionals(const std::optional<Fields> &... values) noexcept : _Bytes{} { _Assign(std::index_sequence_for<Fields...>{}, values...); }
+
+    template<size_t I> bool has_value() const noexcept { return (_Present() >> I) & 1; }
+    template<size_t I> reference<I> get() noexcept { return reference<I>{this}; }
+    template<size_t I> std::optional<const field_type<I> &> get() const noexcept { return has_value<I>() ? std::optional<const field_type<I> &>{_Field<I>()} : std::nullopt; }
+
+    // The presence flags, in which bit I is set if field I has a value, and the number of fields which have values
+    presence_type presence() const noexcept { return _Present(); }
+    size_t count() const noexcept { return static_cast<size_t>(detail::popcount64(_Present())); }
+
+    void reset() noexcept { std::fill_n(_Bytes, _Size, 0); }
+
+    bool operator==(const packed_optionals & r) const { return _Equal(r, std::index_sequence_for<Fields...>{}); }
+    bool operator!=(const packed_optionals & r) const { return !(*this == r); }
+};
+template<class... Fields> constexpr size_t packed_optionals<Fields...>::field_count;
+template<class... Fields> constexpr size_t packed_optionals<Fields...>::_Alignment;
+template<class... Fields> constexpr size_t packed_optionals<Fields...>::_Payload_offset;
+template<class... Fields> constexpr size_t packed_optionals<Fields...>::_Size;
+
+template<size_t I, class... Fields> typename packed_optionals<Fields...>::template reference<I> get(packed_optionals<Fields...> & p) noexcept { return p.template get<I>(); }
+template<size_t I, class... Fields> auto get(const packed_optionals<Fields...> & p) noexcept { return p.template get<I>(); }
+
+} // namespace vocab
+
+#endif
@@ -0,0 +1,242 @@
+// parallel_visit.h provides parallel_visit and parallel_visit_reduce, which
+// visit large ranges of variants on a built-in work-stealing thread pool. It
+// is an extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_PARALLEL_VISIT
+#define VOCAB_TYPES_PARALLEL_VISIT
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "variant.h"
+
+namespace vocab {
+
+namespace detail {
+
+// A batch of chunks, numbered [0, chunk_count), which must all be run before the batch is complete
+struct parallel_job
+{
+    void (* run)(void * context, size_t chunk);
+    void * context;
+    std::atomic<size_t> remaining;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    parallel_job(void (* run)(void *, size_t), void * context, size_t chunk_count) : run{run}, context{context}, remaining{chunk_count} {}
+    bool done() const { return remaining.load(std::memory_order_acquire) == 0; }
+    void execute(size_t chunk)
+    {
+        try { run(context, chunk); }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if(!error) error = std::current_exception();
+        }
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+};
+
+} // namespace vocab::detail
+
+///////////////////////////////////////////////////////////////////////////////
+// work_stealing_pool - a fixed set of worker threads with per-thread deques //
+///////////////////////////////////////////////////////////////////////////////
+
+// Each worker owns a deque of chunk ranges. A worker repeatedly halves the range it is working on,
+// pushing the upper half onto the back of its own deque, until a single chunk remains. Idle workers
+// steal from the front of other deques, where the largest ranges are found. The thread which calls
+// run(...) participates in the work until every chunk of its job has completed.
+class work_stealing_pool
+{
+    struct task { size_t begin, end; detail::parallel_job * job; };
+    struct queue { std::mutex mutex; std::deque<task> tasks; };
+
+    std::vector<std::unique_ptr<queue>> _Queues; // _Queues[0] receives work from threads outside the pool
+    std::vector<std::thread> _Threads;
+    std::atomic<size_t> _Queued {0};
+    std::mutex _Mutex;
+    std::condition_variable _Wake;
+    bool _Stop = false;
+
+    static size_t & _Index_slot() { static thread_local size_t index = 0; return index; }
+    static const work_stealing_pool *& _Pool_slot() { static thread_local const work_stealing_pool * pool = nullptr; return pool; }
+
+    size_t _Self() const { return _Pool_slot() == this ? _Index_slot() : 0; }
+
+    void _Push(size_t q, const task & t)
+    {
+        _Queued.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(_Queues[q]->mutex);
+            _Queues[q]->tasks.push_back(t);
+        }
+        { std::lock_guard<std::mutex> lock(_Mutex); }
+        _Wake.notify_one();
+    }
+
+    bool _Try_pop(size_t self, task & t)
+    {
+        if(_Queued.load(std::memory_order_acquire) == 0) return false;
+        {
+            std::lock_guard<std::mutex> lock(_Queues[self]->mutex);
+            auto & tasks = _Queues[self]->tasks;
+            if(!tasks.empty()) { t = tasks.back(); tasks.pop_back(); _Queued.fetch_sub(1, std::memory_order_relaxed); return true; }
+        }
+        for(size_t i=1; i<_Queues.size(); ++i)
+        {
+            auto & q = *_Queues[(self + i) % _Queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if(!q.tasks.empty()) { t = q.tasks.front(); q.tasks.pop_front(); _Queued.fetch_sub(1, std::memory_order_relaxed); return true; }
+        }
+        return false;
+    }
+
+    void _Execute(size_t self, task t)
+    {
+        while(t.end - t.begin > 1)
+        {
+            const size_t mid = t.begin + (t.end - t.begin) / 2;
+            _Push(self, task{mid, t.end, t.job});
+            t.end = mid;
+        }
+        t.job->execute(t.begin);
+    }
+
+    void _Work(size_t self)
+    {
+        _Pool_slot() = this;
+        _Index_slot() = self;
+        for(task t; ; )
+        {
+            if(_Try_pop(self, t)) _Execute(self, t);
+            else
+            {
+                std::unique_lock<std::mutex> lock(_Mutex);
+                _Wake.wait(lock, [this] { return _Stop || _Queued.load(std::memory_order_acquire) > 0; });
+                if(_Stop) return;
+            }
+        }
+    }
+
+    template<class F> static void _Invoke(void * f, size_t chunk) { (*reinterpret_cast<F *>(f))(chunk); }
+public:
+    explicit work_stealing_pool(size_t thread_count = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0)
+    {
+        _Queues.emplace_back(new queue);
+        for(size_t i=0; i<thread_count; ++i) _Queues.emplace_back(new queue);
+        for(size_t i=0; i<thread_count; ++i) _Threads.emplace_back([this, i] { _Work(i + 1); });
+    }
+    work_stealing_pool(const work_stealing_pool &) = delete;
+    work_stealing_pool & operator = (const work_stealing_pool &) = delete;
+    ~work_stealing_pool()
+    {
+        { std::lock_guard<std::mutex> lock(_Mutex); _Stop = true; }
+        _Wake.notify_all();
+        for(auto & t : _Threads) t.join();
+    }
+
+    // Returns the number of worker threads, not counting threads which call run(...)
+    size_t size() const { return _Threads.size(); }
+
+    // Invokes f(chunk) for every chunk in [0, chunk_count), and returns once all invocations have completed.
+    // If any invocation throws, the first exception caught is rethrown to the caller.
+    template<class F> void run(size_t chunk_count, F & f)
+    {
+        if(chunk_count == 0) return;
+        detail::parallel_job job {&_Invoke<F>, &f, chunk_count};
+        const size_t self = _Self();
+        _Execute(self, task{0, chunk_count, &job});
+        for(task t; !job.done(); )
+        {
+            if(_Try_pop(self, t)) _Execute(self, t);
+            else std::this_thread::yield();
+        }
+        if(job.error) std::rethrow_exception(job.error);
+    }
+
+    // Returns a process-wide pool with one worker for each hardware thread besides the caller's
+    static work_stealing_pool & default_pool() { static work_stealing_pool pool; return pool; }
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+// parallel_visit - invoke a visitor on every variant in a random access range //
+/////////////////////////////////////////////////////////////////////////////////
+
+// The range is divided into chunks of grain consecutive elements, where a grain of zero is treated as
+// one, and vis is invoked concurrently from several threads, so it must be safe to call concurrently
+// on distinct elements
+template<class RandomIt, class Visitor> void parallel_visit(work_stealing_pool & pool, RandomIt first, RandomIt last, Visitor && vis, size_t grain = 1024)
+{
+    grain = std::max<size_t>(grain, 1);
+    const size_t size = static_cast<size_t>(std::distance(first, last)), chunk_count = (size + grain - 1) / grain;
+    auto body = [&](size_t chunk)
+    {
+        const RandomIt end = first + std::min(size, (chunk + 1) * grain);
+        for(RandomIt it = first + chunk * grain; it != end; ++it) std::visit(vis, *it);
+    };
+    pool.run(chunk_count, body);
+}
+template<class RandomIt, class Visitor> void parallel_visit(RandomIt first, RandomIt last, Visitor && vis, size_t grain = 1024) { parallel_visit(work_stealing_pool::default_pool(), first, last, std::forward<Visitor>(vis), grain); }
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+// parallel_visit_reduce - visit every variant in a range, accumulating into per-chunk state //
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+// Each chunk accumulates into its own copy of identity by calling vis(state, alternative), and the
+// per-chunk states are then folded together with combine(state, state) in range order. Because chunk
+// boundaries depend only on grain, the result is deterministic regardless of the number of threads or
+// the order in which chunks run, even when combine is not commutative or involves floating point.
+template<class RandomIt, class T, class Visitor, class Combine> T parallel_visit_reduce(work_stealing_pool & pool, RandomIt first, RandomIt last, T identity, Visitor && vis, Combine && combine, size_t grain = 1024)
+{
+    grain = std::max<size_t>(grain, 1);
+    const size_t size = static_cast<size_t>(std::distance(first, last)), chunk_count = (size + grain - 1) / grain;
+    std::vector<T> states(chunk_count, identity);
+    auto body = [&](size_t chunk)
+    {
+        T & state = states[chunk];
+        const RandomIt end = first + std::min(size, (chunk + 1) * grain);
+        for(RandomIt it = first + chunk * grain; it != end; ++it) std::visit([&](auto && x) { vis(state, std::forward<decltype(x)>(x)); }, *it);
+    };
+    pool.run(chunk_count, body);
+    for(auto & state : states) identity = combine(std::move(identity), std::move(state));
+    return identity;
+}
+template<class RandomIt, class T, class Visitor, class Combine> T parallel_visit_reduce(RandomIt first, RandomIt last, T identity, Visitor && vis, Combine && combine, size_t grain = 1024) { return parallel_visit_reduce(work_stealing_pool::default_pool(), first, last, std::move(identity), std::forward<Visitor>(vis), std::forward<Combine>(combine), grain); }
+
+} // namespace vocab
+
+#endif
@@ -0,0 +1,135 @@
+// pointer_variant.h provides pointer_variant, a variant of pointer types which
+// occupies a single word by storing its index in the low bits of the pointer.
+// It is an extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_POINTER_VARIANT
+#define VOCAB_TYPES_POINTER_VARIANT
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include "variant.h"
+
+namespace vocab {
+
+template<class... Pointers> class pointer_variant;
+
+///////////////////////////////////////////////////////////////////////////////////
+// pointer_variant - variant of pointers, tagged in the pointers' alignment bits //
+///////////////////////////////////////////////////////////////////////////////////
+
+// A pointer_variant<A *, B *, ...> holds exactly one pointer, which may be null, of one of the listed types. The index
+// of the alternative is stored in the low bits of the pointer, which are always zero as the pointee types are aligned
+// to at least 2^ceil(log2(N)) bytes. This is checked when a pointer_variant is first assigned, at which point the
+// pointee types must be complete. A default constructed pointer_variant holds a null pointer of the first type.
+//
+// pointer_variant is trivially copyable and exactly the size of a uintptr_t, so std::atomic<pointer_variant<...>>
+// is lock-free wherever std::atomic<uintptr_t> is.
+template<class... Ts> class pointer_variant<Ts *...>
+{
+    constexpr static size_t alternative_count = sizeof...(Ts);
+    static_assert(alternative_count <= 16, "pointer_variant supports at most 16 alternatives");
+public:
+    constexpr static unsigned tag_bits = alternative_count <= 1 ? 0 : alternative_count <= 2 ? 1 : alternative_count <= 4 ? 2 : alternative_count <= 8 ? 3 : 4;
+    constexpr static uintptr_t tag_mask = (uintptr_t(1) << tag_bits) - 1;
+private:
+    uintptr_t _Bits;
+
+    template<size_t I> static uintptr_t _Encode(std::variant_alternative_t<I, std::variant<Ts *...>> p)
+    {
+        static_assert(alignof(std::remove_pointer_t<decltype(p)>) > tag_mask, "pointee type is not sufficiently aligned to hold the tag of a pointer_variant");
+        return reinterpret_cast<uintptr_t>(p) | I;
+    }
+public:
+    constexpr pointer_variant() noexcept : _Bits{0} {}
+    template<class T, size_t I = std::_Early17::index_of<T *, Ts *...>::value> pointer_variant(T * p) noexcept : _Bits{_Encode<I>(p)} {}
+    template<size_t I> pointer_variant(std::in_place_index_t<I>, std::variant_alternative_t<I, std::variant<Ts *...>> p) noexcept : _Bits{_Encode<I>(p)} {}
+
+    template<class T, size_t I = std::_Early17::index_of<T *, Ts *...>::value> pointer_variant & operator = (T * p) noexcept { _Bits = _Encode<I>(p); return *this; }
+    template<size_t I> void emplace(std::variant_alternative_t<I, std::variant<Ts *...>> p) noexcept { _Bits = _Encode<I>(p); }
+    template<class T> void emplace(T * p) noexcept { _Bits = _Encode<std::_Early17::index_of<T *, Ts *...>::value>(p); }
+
+    constexpr size_t index() const noexcept { return static_cast<size_t>(_Bits & tag_mask); }
+    constexpr bool valueless_by_exception() const noexcept { return false; }
+    void swap(pointer_variant & r) noexcept { std::swap(_Bits, r._Bits); }
+
+    // The held pointer, regardless of its type
+    void * address() const noexcept { return reinterpret_cast<void *>(_Bits & ~tag_mask); }
+    explicit operator bool () const noexcept { return (_Bits & ~tag_mask) != 0; }
+
+    // The encoded representation, for use with external atomics or hash tables
+    uintptr_t raw() const noexcept { return _Bits; }
+    static pointer_variant from_raw(uintptr_t bits) noexcept { pointer_variant v; v._Bits = bits; return v; }
+
+    template<size_t I> std::variant_alternative_t<I, std::variant<Ts *...>> _Unchecked_get() const noexcept { return reinterpret_cast<std::variant_alternative_t<I, std::variant<Ts *...>>>(_Bits & ~tag_mask); }
+};
+template<class... Ts> constexpr unsigned pointer_variant<Ts *...>::tag_bits;
+template<class... Ts> constexpr uintptr_t pointer_variant<Ts *...>::tag_mask;
+
+template<class... Ts> bool operator == (const pointer_variant<Ts...> & a, const pointer_variant<Ts...> & b) noexcept { return a.raw() == b.raw(); }
+template<class... Ts> bool operator != (const pointer_variant<Ts...> & a, const pointer_variant<Ts...> & b) noexcept { return a.raw() != b.raw(); }
+
+template<class T, class... Ts> constexpr bool holds_alternative(const pointer_variant<Ts...> & v) noexcept { return std::_Early17::index_of<T, Ts...>::value == v.index(); }
+
+// get returns the held pointer, or throws std::bad_variant_access if it is of a different type
+template<size_t I, class... Ts> std::variant_alternative_t<I, std::variant<Ts...>> get(const pointer_variant<Ts...> & v) { if(v.index() == I) return v.template _Unchecked_get<I>(); throw std::bad_variant_access{}; }
+template<class T, class... Ts> T get(const pointer_variant<Ts...> & v) { return get<std::_Early17::index_of<T, Ts...>::value>(v); }
+
+// get_if returns the held pointer, or nullptr if pv is null or holds a pointer of a different type. As the alternatives
+// are stored encoded, it returns the pointer itself rather than a pointer to it.
+template<size_t I, class... Ts> std::variant_alternative_t<I, std::variant<Ts...>> get_if(const pointer_variant<Ts...> * pv) noexcept { return pv && pv->index() == I ? pv->template _Unchecked_get<I>() : nullptr; }
+template<class T, class... Ts> T get_if(const pointer_variant<Ts...> * pv) noexcept { return get_if<std::_Early17::index_of<T, Ts...>::value>(pv); }
+
+namespace detail {
+
+template<size_t I, class Visitor, class... Ts> auto visit_pointer(Visitor & vis, const pointer_variant<Ts...> & v) { return vis(v.template _Unchecked_get<I>()); }
+
+template<class Visitor, class... Ts, size_t... I> auto visit_pointer(Visitor & vis, const pointer_variant<Ts...> & v, std::index_sequence<I...>)
+{
+    typedef decltype(vis(v.template _Unchecked_get<0>())) result_type;
+    static result_type (* const table[])(Visitor &, const pointer_variant<Ts...> &) = {&visit_pointer<I, Visitor, Ts...>...};
+    return table[v.index()](vis, v);
+}
+
+} // namespace vocab::detail
+
+// Invoke vis with the held pointer, through a table indexed by the tag bits
+template<class Visitor, class... Ts> auto visit(Visitor && vis, const pointer_variant<Ts...> & v) { return detail::visit_pointer(vis, v, std::make_index_sequence<sizeof...(Ts)>{}); }
+
+} // namespace vocab
+
+namespace std {
+
+template<class... Ts> struct variant_size<vocab::pointer_variant<Ts...>> : std::integral_constant<std::size_t, sizeof...(Ts)> {};
+template<size_t I, class... Ts> class variant_alternative<I, vocab::pointer_variant<Ts...>> : public variant_alternative<I, std::variant<Ts...>> {};
+template<class... Ts> struct hash<vocab::pointer_variant<Ts...>> { size_t operator() (const vocab::pointer_variant<Ts...> & v) const { return std::hash<uintptr_t>{}(v.raw()); } };
+
+} // namespace std
+
+#endif
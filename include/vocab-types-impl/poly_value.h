@@ -0,0 +1,150 @@
+// poly_value.h provides poly_value, which holds a value of any type derived
+// from a given base class in bounded inline storage, with value semantics and
+// no heap allocation. It is an extension to vocab-types, and its permanent
+// home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_POLY_VALUE
+#define VOCAB_TYPES_POLY_VALUE
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include "utility.h"
+
+namespace vocab {
+
+////////////////////////////////////////////////////////////////////////////////////
+// poly_value - value of a type derived from Base, stored inline in MaxSize bytes //
+////////////////////////////////////////////////////////////////////////////////////
+
+// Like std::any, poly_value erases the type of its contents behind a table of operations, but the table is a static
+// manager per stored type rather than the vtable of a heap allocated holder, and the value lives in storage inside
+// the poly_value itself. A pointer to the Base subobject is computed once when a value is stored, so that get() and
+// operator-> are plain loads. Storing a type which is larger than MaxSize, more aligned than Align, or not derived
+// from Base fails to compile.
+//
+// Copying a poly_value copies the contained value, and moving a poly_value moves the contained value and leaves the
+// source empty. If copying the contained value throws, the destination is left empty. The stored types must be nothrow
+// move constructible, so that moving a poly_value never throws, and containers of poly_value move rather than copy
+// their elements when they grow.
+template<class Base, size_t MaxSize = 64, size_t Align = alignof(std::max_align_t)> class poly_value
+{
+    struct manager
+    {
+        Base * (* copy)(void * dst, const void * src);
+        Base * (* move)(void * dst, void * src); // Also destroys the source
+        void (* destroy)(void * p);
+        const std::type_info & (* type)();
+    };
+    template<class T> struct manager_for
+    {
+        static Base * copy(void * dst, const void * src) { return new(dst) T(*static_cast<const T *>(src)); }
+        static Base * move(void * dst, void * src) noexcept { T & s = *static_cast<T *>(src); Base * b = new(dst) T(std::move(s)); s.~T(); return b; }
+        static void destroy(void * p) { static_cast<T *>(p)->~T(); }
+        static const std::type_info & type() { return typeid(T); }
+        static const manager table;
+    };
+
+    std::aligned_storage_t<MaxSize, Align> _Storage;
+    Base * _Ptr = nullptr;
+    const manager * _Manager = nullptr;
+
+    template<class T> void _Check() const
+    {
+        static_assert(std::is_base_of<Base, T>::value, "poly_value can only hold types derived from Base");
+        static_assert(sizeof(T) <= MaxSize, "type is too large for the inline storage of this poly_value");
+        static_assert(alignof(T) <= Align, "type is too strictly aligned for the inline storage of this poly_value");
+        static_assert(std::is_copy_constructible<T>::value, "poly_value can only hold copy constructible types");
+        static_assert(std::is_nothrow_move_constructible<T>::value, "poly_value can only hold nothrow move constructible types");
+    }
+public:
+    typedef Base element_type;
+    constexpr static size_t max_size = MaxSize, alignment = Align;
+
+    poly_value() noexcept {}
+    poly_value(const poly_value & r) { if(r._Manager) { _Ptr = r._Manager->copy(&_Storage, &r._Storage); _Manager = r._Manager; } }
+    poly_value(poly_value && r) noexcept { if(r._Manager) { _Ptr = r._Manager->move(&_Storage, &r._Storage); _Manager = r._Manager; r._Ptr = nullptr; r._Manager = nullptr; } }
+    template<class T, class = std::enable_if_t<!std::is_same<std::decay_t<T>, poly_value>::value>> poly_value(T && value) { emplace<std::decay_t<T>>(std::forward<T>(value)); }
+    template<class T, class... Args> explicit poly_value(std::in_place_type_t<T>, Args &&... args) { emplace<T>(std::forward<Args>(args)...); }
+    ~poly_value() { reset(); }
+
+    poly_value & operator = (const poly_value & r)
+    {
+        if(this == &r) return *this;
+        reset();
+        if(r._Manager) { _Ptr = r._Manager->copy(&_Storage, &r._Storage); _Manager = r._Manager; }
+        return *this;
+    }
+    poly_value & operator = (poly_value && r) noexcept
+    {
+        if(this == &r) return *this;
+        reset();
+        if(r._Manager) { _Ptr = r._Manager->move(&_Storage, &r._Storage); _Manager = r._Manager; r._Ptr = nullptr; r._Manager = nullptr; }
+        return *this;
+    }
+    template<class T, class = std::enable_if_t<!std::is_same<std::decay_t<T>, poly_value>::value>> poly_value & operator = (T && value) { emplace<std::decay_t<T>>(std::forward<T>(value)); return *this; }
+
+    template<class T, class... Args> T & emplace(Args &&... args)
+    {
+        _Check<T>();
+        reset();
+        T * p = new(&_Storage) T(std::forward<Args>(args)...);
+        _Ptr = p;
+        _Manager = &manager_for<T>::table;
+        return *p;
+    }
+    void reset() noexcept
+    {
+        if(!_Manager) return;
+        _Manager->destroy(&_Storage);
+        _Ptr = nullptr;
+        _Manager = nullptr;
+    }
+
+    bool has_value() const noexcept { return _Ptr != nullptr; }
+    explicit operator bool () const noexcept { return _Ptr != nullptr; }
+    const std::type_info & type() const noexcept { return _Manager ? _Manager->type() : typeid(void); }
+
+    Base * get() noexcept { return _Ptr; }
+    const Base * get() const noexcept { return _Ptr; }
+    Base * operator -> () noexcept { return _Ptr; }
+    const Base * operator -> () const noexcept { return _Ptr; }
+    Base & operator * () noexcept { return *_Ptr; }
+    const Base & operator * () const noexcept { return *_Ptr; }
+};
+
+template<class Base, size_t MaxSize, size_t Align> constexpr size_t poly_value<Base, MaxSize, Align>::max_size;
+template<class Base, size_t MaxSize, size_t Align> constexpr size_t poly_value<Base, MaxSize, Align>::alignment;
+template<class Base, size_t MaxSize, size_t Align> template<class T> const typename poly_value<Base, MaxSize, Align>::manager poly_value<Base, MaxSize, Align>::manager_for<T>::table =
+    {&manager_for<T>::copy, &manager_for<T>::move, &manager_for<T>::destroy, &manager_for<T>::type};
+
+} // namespace vocab
+
+#endif
@@ -0,0 +1,312 @@
+// shm_variant_queue.h provides shm_variant_queue, a lock-free queue of
+// variants of trivially copyable types which lives in POSIX shared memory
+// and can be used to exchange messages between processes on Linux. It is an
+// extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_SHM_VARIANT_QUEUE
+#define VOCAB_TYPES_SHM_VARIANT_QUEUE
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <system_error>
+#include <thread>
+#include <typeinfo>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "atomic_variant.h"
+#include "variant.h"
+
+namespace vocab {
+
+namespace detail {
+
+// A hash of the mangled name, size and alignment of each of Types, in order. Mangled names follow the platform ABI
+// rather than the compiler, so programs built by different compilers agree on them, and a type is identified by its
+// fully qualified name, so two programs which define different types under the same name are not told apart.
+template<class... Types> uint64_t shm_layout_signature()
+{
+    const char * names[] = {typeid(Types).name()...};
+    const uint64_t layouts[] = {(sizeof(Types) << 8 | alignof(Types))...};
+    uint64_t h = 14695981039346656037ull;
+    for(size_t i=0; i<sizeof...(Types); ++i)
+    {
+        for(const char * c = names[i]; *c; ++c) h = (h ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+        h = (h ^ layouts[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+// Waits until *word != expected, a wakeup is delivered, or the timeout elapses. The timeout ensures that a waiter
+// will eventually notice progress even if the process which should have woken it has died.
+inline void futex_wait(std::atomic<uint32_t> & word, uint32_t expected, long timeout_ns)
+{
+    const timespec timeout {timeout_ns / 1000000000, timeout_ns % 1000000000};
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+inline void futex_wake_all(std::atomic<uint32_t> & word) { syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0); }
+
+[[noreturn]] inline void throw_errno(const char * what) { throw std::system_error(errno, std::generic_category(), what); }
+
+} // namespace vocab::detail
+
+////////////////////////////////////////////////////////////////////////////////////
+// shm_variant_queue - bounded inter-process queue of trivially copyable variants //
+////////////////////////////////////////////////////////////////////////////////////
+
+// The segment begins with a header, followed by a ring of slots which each hold a sequence number and a
+// std::variant<Types...>, and uses the same algorithm as variant_channel. Because every alternative is trivially
+// copyable, the variant's tag and payload are meaningful in any process which maps the segment, so messages are
+// constructed directly in the segment by the sender and visited directly in the segment by the receiver.
+//
+// The header records a magic number, the capacity, and a signature of the names, sizes and alignments of the
+// alternatives, in order, so that a process compiled with a different set or order of alternatives fails to attach
+// rather than misinterpreting messages. The header is
+// initialized by whichever process first claims it, and if that process dies partway through, the next process to
+// attach takes over initialization. Blocking operations sleep on futexes in the segment with a bounded timeout, so
+// that the death of a peer can delay, but never permanently block, a waiter.
+template<class... Types> class shm_variant_queue
+{
+public:
+    typedef std::variant<Types...> value_type;
+private:
+    static_assert(detail::all_trivially_copyable<Types...>::value, "shm_variant_queue requires trivially copyable alternatives");
+    constexpr static uint64_t magic = 0x766172715F73686Dull;
+    enum : uint32_t { uninitialized, ready };
+
+    struct header
+    {
+        std::atomic<uint32_t> state;
+        std::atomic<int32_t> initializer;
+        uint64_t magic, signature, capacity;
+        alignas(64) std::atomic<uint64_t> enqueue_pos;
+        alignas(64) std::atomic<uint64_t> dequeue_pos;
+        alignas(64) std::atomic<uint32_t> items_futex, items_waiters;
+        alignas(64) std::atomic<uint32_t> space_futex, space_waiters;
+    };
+    struct slot
+    {
+        std::atomic<uint64_t> sequence;
+        bool valueless;
+        std::aligned_storage_t<sizeof(value_type), alignof(value_type)> storage;
+        value_type & value() { return reinterpret_cast<value_type &>(storage); }
+    };
+
+    int _Fd = -1;
+    size_t _Size = 0;
+    header * _Header = nullptr;
+    slot * _Slots = nullptr;
+    uint64_t _Mask = 0;
+
+    static size_t _Segment_size(size_t capacity) { return sizeof(header) + sizeof(slot) * capacity; }
+
+    // The process which creates a segment sizes it straight away, so a segment which remains empty for a second was
+    // left behind by a creator which died, and the caller may size it instead
+    static size_t _Existing_size(int fd)
+    {
+        for(int i=0; i<1000; ++i)
+        {
+            struct stat st;
+            if(fstat(fd, &st) != 0) detail::throw_errno("fstat");
+            if(st.st_size) return static_cast<size_t>(st.st_size);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return 0;
+    }
+    static size_t _Round_up(size_t n) { size_t p = 2; while(p < n) p *= 2; return p; }
+
+    void _Initialize(size_t capacity)
+    {
+        _Header->magic = 0;
+        _Header->signature = detail::shm_layout_signature<value_type, Types...>();
+        _Header->capacity = capacity;
+        _Header->enqueue_pos.store(0);
+        _Header->dequeue_pos.store(0);
+        _Header->items_futex.store(0);
+        _Header->items_waiters.store(0);
+        _Header->space_futex.store(0);
+        _Header->space_waiters.store(0);
+        for(size_t i=0; i<capacity; ++i) _Slots[i].sequence.store(i, std::memory_order_relaxed);
+        _Header->magic = magic;
+        _Header->state.store(ready, std::memory_order_release);
+    }
+
+    void _Attach(size_t capacity)
+    {
+        while(_Header->state.load(std::memory_order_acquire) != ready)
+        {
+            // Claim initialization if nobody has begun it, or if the process which began it no longer exists
+            int32_t initializer = _Header->initializer.load();
+            if((initializer == 0 || (kill(initializer, 0) != 0 && errno == ESRCH)) && _Header->initializer.compare_exchange_strong(initializer, getpid()))
+            {
+                _Initialize(capacity);
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if(_Header->magic != magic || _Header->signature != detail::shm_layout_signature<value_type, Types...>() || _Header->capacity != capacity) throw std::runtime_error("shm_variant_queue: shared memory segment has an incompatible layout");
+    }
+
+    slot * _Claim_for_write()
+    {
+        for(uint64_t pos = _Header->enqueue_pos.load(std::memory_order_relaxed); ; )
+        {
+            slot & s = _Slots[pos & _Mask];
+            const auto diff = static_cast<int64_t>(s.sequence.load(std::memory_order_acquire) - pos);
+            if(diff == 0) { if(_Header->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &s; }
+            else if(diff < 0) return nullptr;
+            else pos = _Header->enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot * _Claim_for_read(uint64_t & claimed)
+    {
+        for(uint64_t pos = _Header->dequeue_pos.load(std::memory_order_relaxed); ; )
+        {
+            slot & s = _Slots[pos & _Mask];
+            const auto diff = static_cast<int64_t>(s.sequence.load(std::memory_order_acquire) - (pos + 1));
+            if(diff == 0) { if(_Header->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { claimed = pos; return &s; } }
+            else if(diff < 0) return nullptr;
+            else pos = _Header->dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    static void _Signal(std::atomic<uint32_t> & futex, std::atomic<uint32_t> & waiters) { futex.fetch_add(1); if(waiters.load()) detail::futex_wake_all(futex); }
+    template<class F> static void _Block(std::atomic<uint32_t> & futex, std::atomic<uint32_t> & waiters, F && try_once)
+    {
+        for(;;)
+        {
+            if(try_once()) return;
+            waiters.fetch_add(1);
+            const uint32_t seen = futex.load();
+            const bool done = try_once();
+            if(!done) detail::futex_wait(futex, seen, 100000000);
+            waiters.fetch_sub(1);
+            if(done) return;
+        }
+    }
+public:
+    // Opens the named segment, creating and initializing it if it does not already exist. Every process attaching
+    // to the same segment must specify the same capacity, which is rounded up to a power of two. Only the process
+    // which creates a segment sets its size, and any other refuses a segment of the wrong size without resizing it.
+    shm_variant_queue(const char * name, size_t capacity)
+    {
+        capacity = _Round_up(capacity);
+        _Fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        const bool created = _Fd >= 0;
+        if(!created && errno == EEXIST) _Fd = shm_open(name, O_RDWR, 0600);
+        if(_Fd < 0) detail::throw_errno("shm_open");
+        _Size = _Segment_size(capacity);
+        try
+        {
+            const size_t existing = created ? 0 : _Existing_size(_Fd);
+            if(existing != 0 && existing != _Size) throw std::runtime_error("shm_variant_queue: shared memory segment has an incompatible layout");
+            if(existing == 0 && ftruncate(_Fd, _Size) != 0) detail::throw_errno("ftruncate");
+        }
+        catch(...) { close(_Fd); throw; }
+        void * p = mmap(nullptr, _Size, PROT_READ | PROT_WRITE, MAP_SHARED, _Fd, 0);
+        if(p == MAP_FAILED) { close(_Fd); detail::throw_errno("mmap"); }
+        _Header = reinterpret_cast<header *>(p);
+        _Slots = reinterpret_cast<slot *>(reinterpret_cast<char *>(p) + sizeof(header));
+        _Mask = capacity - 1;
+        try { _Attach(capacity); }
+        catch(...) { munmap(p, _Size); close(_Fd); throw; }
+    }
+    shm_variant_queue(const shm_variant_queue &) = delete;
+    shm_variant_queue & operator = (const shm_variant_queue &) = delete;
+    ~shm_variant_queue() { munmap(_Header, _Size); close(_Fd); }
+
+    // Removes the name of a segment, which is destroyed once every process has detached from it
+    static void unlink(const char * name) { shm_unlink(name); }
+
+    size_t capacity() const { return _Mask + 1; }
+
+    // Construct a message of alternative I or T directly in the segment, returning false if the queue is full
+    template<size_t I, class... Args> bool try_emplace(Args &&... args)
+    {
+        slot * s = _Claim_for_write();
+        if(!s) return false;
+        const uint64_t next = s->sequence.load(std::memory_order_relaxed) + 1;
+        try
+        {
+            new(&s->storage) value_type(std::in_place<I>, std::forward<Args>(args)...);
+            s->valueless = false;
+        }
+        catch(...)
+        {
+            // The slot has already been claimed, so publish it as empty, and receivers will skip over it
+            s->valueless = true;
+            s->sequence.store(next, std::memory_order_release);
+            _Signal(_Header->items_futex, _Header->items_waiters);
+            throw;
+        }
+        s->sequence.store(next, std::memory_order_release);
+        _Signal(_Header->items_futex, _Header->items_waiters);
+        return true;
+    }
+    template<class T, class... Args> bool try_emplace(Args &&... args) { return try_emplace<std::_Early17::index_of<T, Types...>::value>(std::forward<Args>(args)...); }
+    template<size_t I, class... Args> void emplace(Args &&... args) { _Block(_Header->space_futex, _Header->space_waiters, [&] { return try_emplace<I>(args...); }); }
+    template<class T, class... Args> void emplace(Args &&... args) { emplace<std::_Early17::index_of<T, Types...>::value>(std::forward<Args>(args)...); }
+
+    // Visit the oldest message in the segment, returning false if the queue is empty. Slots left empty by a sender
+    // whose constructor threw are released and skipped.
+    template<class Visitor> bool try_receive(Visitor && vis)
+    {
+        for(;;)
+        {
+            uint64_t pos;
+            slot * s = _Claim_for_read(pos);
+            if(!s) return false;
+            struct release
+            {
+                shm_variant_queue & q; slot & s; uint64_t next;
+                ~release() { s.sequence.store(next, std::memory_order_release); _Signal(q._Header->space_futex, q._Header->space_waiters); }
+            } guard {*this, *s, pos + _Mask + 1};
+            if(s->valueless) continue;
+            std::visit(vis, s->value());
+            return true;
+        }
+    }
+    template<class Visitor> void receive(Visitor && vis) { _Block(_Header->items_futex, _Header->items_waiters, [&] { return try_receive(vis); }); }
+};
+
+} // namespace vocab
+
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+// sort_variants.h provides sort_variants, which sorts a range of variants by
+// partitioning it on index() and then sorting each homogeneous bucket with an
+// algorithm suited to its alternative type. It is an extension to
+// vocab-types, and its permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_SORT_VARIANTS
+#define VOCAB_TYPES_SORT_VARIANTS
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "variant.h"
+#include "string_view.h"
+
+namespace vocab {
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////////
+// radix_key - order-preserving mapping of arithmetic values to unsigned keys //
+////////////////////////////////////////////////////////////////////////////////
+
+// Signed integers have their sign bit flipped. Floating point values have all bits flipped if negative, and only
+// the sign bit flipped otherwise, so that keys compare as the values do under operator<, with NaNs placed at the
+// ends according to their sign bit.
+template<class T, class = void> struct radix_key { constexpr static bool enabled = false; };
+template<class T> struct radix_key<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>>
+{
+    constexpr static bool enabled = true;
+    typedef std::make_unsigned_t<T> type;
+    constexpr static type flip = std::is_signed<T>::value ? type(type(1) << (sizeof(T) * 8 - 1)) : type(0);
+    static type encode(T value) { return static_cast<type>(static_cast<type>(value) ^ flip); }
+    static T decode(type key) { return static_cast<T>(static_cast<type>(key ^ flip)); }
+};
+template<class T, class U> struct float_radix_key
+{
+    constexpr static bool enabled = true;
+    typedef U type;
+    constexpr static type sign = type(1) << (sizeof(U) * 8 - 1);
+    static type encode(T value) { type u; std::memcpy(&u, &value, sizeof(u)); return u & sign ? type(~u) : type(u | sign); }
+    static T decode(type key) { const type u = key & sign ? type(key & ~sign) : type(~key); T value; std::memcpy(&value, &u, sizeof(value)); return value; }
+};
+template<> struct radix_key<float> : float_radix_key<float, uint32_t> {};
+template<> struct radix_key<double> : float_radix_key<double, uint64_t> {};
+
+// LSD radix sort on bytes, skipping passes in which every key has the same digit
+template<class K> void radix_sort(std::vector<K> & keys)
+{
+    std::vector<K> temp(keys.size());
+    for(unsigned shift=0; shift<sizeof(K)*8; shift+=8)
+    {
+        size_t offsets[257] = {};
+        for(K k : keys) ++offsets[(k >> shift & 0xFF) + 1];
+        if(offsets[(keys.front() >> shift & 0xFF) + 1] == keys.size()) continue;
+        for(size_t i=1; i<257; ++i) offsets[i] += offsets[i-1];
+        for(K k : keys) temp[offsets[k >> shift & 0xFF]++] = k;
+        keys.swap(temp);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// multikey_quicksort - three-way radix quicksort of narrow strings and views //
+////////////////////////////////////////////////////////////////////////////////
+
+// Strings are partitioned on one character at a time, so that shared prefixes are examined only once per string,
+// rather than once per comparison. Characters are compared as unsigned char, as std::char_traits<char> does.
+template<class S> struct is_narrow_string : std::false_type {};
+template<class A> struct is_narrow_string<std::basic_string<char, std::char_traits<char>, A>> : std::true_type {};
+template<> struct is_narrow_string<std::basic_string_view<char, std::char_traits<char>>> : std::true_type {};
+
+template<class S> int char_at(const S & s, size_t d) { return d < s.size() ? static_cast<unsigned char>(s[d]) : -1; }
+
+template<class S> void multikey_quicksort(S * a, size_t n, size_t d)
+{
+    while(n > 16)
+    {
+        const int x = char_at(a[0], d), y = char_at(a[n/2], d), z = char_at(a[n-1], d);
+        const int pivot = std::max(std::min(x, y), std::min(std::max(x, y), z));
+        size_t lt = 0, i = 0, gt = n;
+        while(i < gt)
+        {
+            const int c = char_at(a[i], d);
+            if(c < pivot) std::swap(a[lt++], a[i++]);
+            else if(c > pivot) std::swap(a[i], a[--gt]);
+            else ++i;
+        }
+        multikey_quicksort(a, lt, d);
+        multikey_quicksort(a + gt, n - gt, d);
+        if(pivot < 0) return; // Every string in the middle partition ends at d, and so they are all equal
+        a += lt; n = gt - lt; ++d;
+    }
+    std::sort(a, a + n);
+}
+
+/////////////////////////////////////////////////////////////////////////
+// sort_bucket - sort a range of variants which all hold alternative I //
+/////////////////////////////////////////////////////////////////////////
+
+template<size_t I, class RandomIt> void sort_bucket(RandomIt first, RandomIt last, std::integral_constant<int, 0>)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type V;
+    std::stable_sort(first, last, [](const V & a, const V & b) { return a.template _Unchecked_get<I>() < b.template _Unchecked_get<I>(); });
+}
+template<size_t I, class RandomIt> void sort_bucket(RandomIt first, RandomIt last, std::integral_constant<int, 1>)
+{
+    typedef radix_key<std::variant_alternative_t<I, typename std::iterator_traits<RandomIt>::value_type>> R;
+    std::vector<typename R::type> keys;
+    keys.reserve(last - first);
+    for(auto it = first; it != last; ++it) keys.push_back(R::encode(it->template _Unchecked_get<I>()));
+    radix_sort(keys);
+    for(auto k : keys) (first++)->template _Unchecked_get<I>() = R::decode(k);
+}
+template<size_t I, class RandomIt> void sort_bucket(RandomIt first, RandomIt last, std::integral_constant<int, 2>)
+{
+    std::vector<std::variant_alternative_t<I, typename std::iterator_traits<RandomIt>::value_type>> values;
+    values.reserve(last - first);
+    for(auto it = first; it != last; ++it) values.push_back(std::move(it->template _Unchecked_get<I>()));
+    multikey_quicksort(values.data(), values.size(), 0);
+    for(auto & v : values) (first++)->template _Unchecked_get<I>() = std::move(v);
+}
+template<size_t I, class RandomIt> void sort_bucket(RandomIt first, RandomIt last)
+{
+    typedef std::variant_alternative_t<I, typename std::iterator_traits<RandomIt>::value_type> T;
+    sort_bucket<I>(first, last, std::integral_constant<int, radix_key<T>::enabled ? 1 : is_narrow_string<T>::value ? 2 : 0>{});
+}
+template<class RandomIt, size_t... I> void sort_bucket(size_t index, RandomIt first, RandomIt last, std::index_sequence<I...>)
+{
+    static void (* const table[])(RandomIt, RandomIt) = {&sort_bucket<I, RandomIt>...};
+    table[index](first, last);
+}
+
+} // namespace vocab::detail
+
+/////////////////////////////////////////////////////////////////////////////////////
+// sort_variants - sort a range of variants, consistently with variant's operator< //
+/////////////////////////////////////////////////////////////////////////////////////
+
+// The range is first stably partitioned by index(), with valueless variants first, using a counting sort. Each
+// bucket then holds a single alternative, and is sorted without any per-comparison dispatch: integers and floating
+// point values with an LSD radix sort, narrow strings and string views with a multikey quicksort, and any other type
+// with std::stable_sort using its operator<. The resulting order is one which std::sort with variant's operator<
+// could have produced.
+template<class RandomIt> void sort_variants(RandomIt first, RandomIt last)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type variant_type;
+    constexpr size_t N = std::variant_size<variant_type>::value;
+    const size_t n = static_cast<size_t>(last - first);
+
+    // Counting sort on index() + 1, which maps variant_npos to bucket 0
+    size_t offsets[N + 2] = {};
+    for(auto it = first; it != last; ++it) ++offsets[it->index() + 2];
+    for(size_t i=1; i<N+2; ++i) offsets[i] += offsets[i-1];
+    if(!std::is_sorted(first, last, [](const variant_type & a, const variant_type & b) { return a.index() + 1 < b.index() + 1; }))
+    {
+        std::vector<size_t> order(n);
+        size_t next[N + 1];
+        std::copy(offsets, offsets + N + 1, next);
+        for(size_t i=0; i<n; ++i) order[next[first[i].index() + 1]++] = i;
+        std::vector<variant_type> sorted;
+        sorted.reserve(n);
+        for(size_t i : order) sorted.push_back(std::move(first[i]));
+        std::move(sorted.begin(), sorted.end(), first);
+    }
+
+    // Sort each bucket which holds a value
+    for(size_t i=0; i<N; ++i) if(offsets[i+2] - offsets[i+1] > 1) detail::sort_bucket(i, first + offsets[i+1], first + offsets[i+2], std::make_index_sequence<N>{});
+}
+
+} // namespace vocab
+
+#endif
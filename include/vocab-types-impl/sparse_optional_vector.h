@@ -0,0 +1,191 @@
+// sparse_optional_vector.h provides sparse_optional_vector, a growable array
+// of optional values which stores only its engaged values, contiguously, and
+// finds them through a bitmap with a rank index. It is an extension to
+// vocab-types, and its permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_SPARSE_OPTIONAL_VECTOR
+#define VOCAB_TYPES_SPARSE_OPTIONAL_VECTOR
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include "optional.h"
+#include "bit_ops.h"
+
+namespace vocab {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// sparse_optional_vector - array of mostly empty optionals, storing only engaged ones //
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// A sparse_optional_vector<T> holds the same elements as a std::vector<std::optional<T>>, but stores only the values
+// of its engaged elements, contiguously and in order of index. Whether each element is engaged is stored as one bit
+// in an array of 64 bit words, alongside which a rank index holds the number of engaged elements before each word,
+// so that an element costs two bits plus sizeof(T) if it is engaged. A column which is 99% empty thus stores its
+// doubles in under three bits per element, against the 65 of an optional_array or the 128 of a vector of optionals.
+//
+// rank(i), the position of element i among the engaged values, is one lookup in the index plus one popcount, so
+// operator[] is O(1), and returns an optional reference to the element. select(k), the index of the k-th engaged
+// element, is a binary search of the index. for_each_engaged visits only the engaged elements, a bitmap word at a
+// time. Appending elements is amortized O(1), as is assigning to an engaged element, but engaging or resetting an
+// element before the last engaged one moves the values after it and updates the index, in O(count() + size() / 64).
+template<class T> class sparse_optional_vector
+{
+    size_t _Size = 0;
+    std::vector<uint64_t> _Bits;
+    std::vector<size_t> _Ranks;
+    std::vector<T> _Values;
+
+    size_t _Rank(size_t i) const noexcept { return _Ranks[i >> 6] + detail::popcount64(_Bits[i >> 6] & detail::low_bits64(i & 63)); }
+    void _Resize_words(size_t n)
+    {
+        _Bits.resize((n + 63) / 64, 0);
+        _Ranks.resize(_Bits.size(), _Values.size());
+        if(n & 63) _Bits.back() &= detail::low_bits64(n & 63);
+    }
+
+    // Engage the empty element i with a value, or reset the engaged element i
+    template<class U> void _Insert(size_t i, U && value)
+    {
+        _Values.insert(_Values.begin() + _Rank(i), std::forward<U>(value));
+        _Bits[i >> 6] |= uint64_t(1) << (i & 63);
+        for(size_t w = (i >> 6) + 1; w < _Ranks.size(); ++w) ++_Ranks[w];
+    }
+    void _Erase(size_t i)
+    {
+        _Values.erase(_Values.begin() + _Rank(i));
+        _Bits[i >> 6] &= ~(uint64_t(1) << (i & 63));
+        for(size_t w = (i >> 6) + 1; w < _Ranks.size(); ++w) --_Ranks[w];
+    }
+    template<class U> void _Assign(size_t i, U && value)
+    {
+        if(has_value(i)) _Values[_Rank(i)] = std::forward<U>(value);
+        else _Insert(i, std::forward<U>(value));
+    }
+    template<class U> void _Push_back(U && value)
+    {
+        _Resize_words(_Size + 1);
+        try { _Values.push_back(std::forward<U>(value)); }
+        catch(...) { _Resize_words(_Size); throw; }
+        _Bits.back() |= uint64_t(1) << (_Size++ & 63);
+    }
+public:
+    typedef T value_type;
+    typedef std::optional<const T &> const_reference;
+
+    // A proxy for an element, which reads like a std::optional<T &> to it, and assigns through to it
+    class reference
+    {
+        friend class sparse_optional_vector;
+        sparse_optional_vector * _Vector;
+        size_t _Index;
+        reference(sparse_optional_vector * vector, size_t index) noexcept : _Vector{vector}, _Index{index} {}
+    public:
+        reference(const reference &) = default;
+
+        bool has_value() const noexcept { return _Vector->has_value(_Index); }
+        explicit operator bool() const noexcept { return _Vector->has_value(_Index); }
+        T & operator*() const noexcept { return _Vector->_Values[_Vector->_Rank(_Index)]; }
+        T * operator->() const noexcept { return &**this; }
+        T & value() const { if(!has_value()) throw std::bad_optional_access{}; return **this; }
+        template<class U> T value_or(U && default_value) const { return has_value() ? **this : static_cast<T>(std::forward<U>(default_value)); }
+
+        reference & operator=(const T & value) { _Vector->_Assign(_Index, value); return *this; }
+        reference & operator=(T && value) { _Vector->_Assign(_Index, std::move(value)); return *this; }
+        reference & operator=(std::nullopt_t) { reset(); return *this; }
+        reference & operator=(const std::optional<T> & value) { if(value) *this = *value; else reset(); return *this; }
+        reference & operator=(const reference & r) { if(r.has_value()) *this = *r; else reset(); return *this; }
+        void reset() { if(has_value()) _Vector->_Erase(_Index); }
+
+        operator std::optional<T &>() const noexcept { return has_value() ? std::optional<T &>{**this} : std::nullopt; }
+        operator std::optional<T>() const { return has_value() ? std::optional<T>{**this} : std::nullopt; }
+    };
+
+    sparse_optional_vector() = default;
+    explicit sparse_optional_vector(size_t count) { resize(count); }
+    sparse_optional_vector(std::initializer_list<std::optional<T>> ilist) : sparse_optional_vector(ilist.begin(), ilist.end()) {}
+    template<class InputIt> sparse_optional_vector(InputIt first, InputIt last) { for(; first != last; ++first) push_back(*first); }
+
+    size_t size() const noexcept { return _Size; }
+    bool empty() const noexcept { return _Size == 0; }
+    void clear() noexcept { _Size = 0; _Bits.clear(); _Ranks.clear(); _Values.clear(); }
+
+    // Elements added by growing the vector are empty
+    void resize(size_t count)
+    {
+        if(count < _Size) _Values.erase(_Values.begin() + rank(count), _Values.end());
+        _Size = count;
+        _Resize_words(count);
+    }
+
+    void push_back(std::nullopt_t) { ++_Size; _Resize_words(_Size); }
+    void push_back(const T & value) { _Push_back(value); }
+    void push_back(T && value) { _Push_back(std::move(value)); }
+    void push_back(const std::optional<T> & value) { if(value) push_back(*value); else push_back(std::nullopt); }
+    void pop_back() { resize(_Size - 1); }
+
+    bool has_value(size_t i) const noexcept { return (_Bits[i >> 6] >> (i & 63)) & 1; }
+    reference operator[](size_t i) noexcept { return {this, i}; }
+    const_reference operator[](size_t i) const noexcept { return has_value(i) ? const_reference{_Values[_Rank(i)]} : std::nullopt; }
+
+    // The number of engaged elements, the number of engaged elements before element i, for 0 <= i <= size(), and the
+    // index of the engaged element which has k engaged elements before it, for 0 <= k < count()
+    size_t count() const noexcept { return _Values.size(); }
+    size_t rank(size_t i) const noexcept { return i == _Size ? _Values.size() : _Rank(i); }
+    size_t select(size_t k) const noexcept
+    {
+        const size_t w = std::upper_bound(_Ranks.begin(), _Ranks.end(), k) - _Ranks.begin() - 1;
+        return w * 64 + detail::select64(_Bits[w], static_cast<unsigned>(k - _Ranks[w]));
+    }
+
+    // Invoke f(index, value) for each engaged element, in order of index
+    template<class F> void for_each_engaged(F && f) { _For_each_engaged(*this, f); }
+    template<class F> void for_each_engaged(F && f) const { _For_each_engaged(*this, f); }
+
+    // The values of the engaged elements, in order of index, and the bitmap, in which bit i % 64 of word i / 64 is set
+    // if element i is engaged, and the bits past size() are zero
+    T * values() noexcept { return _Values.data(); }
+    const T * values() const noexcept { return _Values.data(); }
+    const uint64_t * bitmap() const noexcept { return _Bits.data(); }
+    size_t bitmap_words() const noexcept { return _Bits.size(); }
+private:
+    template<class Vector, class F> static void _For_each_engaged(Vector & v, F & f)
+    {
+        auto value = v._Values.begin();
+        for(size_t w=0; w<v._Bits.size(); ++w)
+        {
+            for(uint64_t bits = v._Bits[w]; bits; bits &= bits - 1) f(w * 64 + detail::countr_zero64(bits), *value++);
+        }
+    }
+};
+
+} // namespace vocab
+
+#endif
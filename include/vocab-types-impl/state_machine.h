@@ -0,0 +1,150 @@
+// state_machine.h provides state_machine, which drives a variant of states
+// from a variant of events through a compile-time transition table. It is an
+// extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_STATE_MACHINE
+#define VOCAB_TYPES_STATE_MACHINE
+
+#include <utility>
+#include "variant.h"
+
+namespace vocab {
+
+namespace detail {
+
+template<class... T> struct make_void { typedef void type; };
+
+// Determine the result of t(state, event), or no_transition if Transitions does not handle the pair
+struct no_transition {};
+template<class T, class S, class E, class = void> struct transition_result { typedef no_transition type; };
+template<class T, class S, class E> struct transition_result<T, S, E, typename make_void<decltype(std::declval<T &>()(std::declval<S &>(), std::declval<const E &>()))>::type> { typedef decltype(std::declval<T &>()(std::declval<S &>(), std::declval<const E &>())) type; };
+
+// Determine whether Transitions provides on_entry(S &) and on_exit(S &) hooks
+template<class T, class S, class = void> struct has_on_entry : std::false_type {};
+template<class T, class S> struct has_on_entry<T, S, typename make_void<decltype(std::declval<T &>().on_entry(std::declval<S &>()))>::type> : std::true_type {};
+template<class T, class S, class = void> struct has_on_exit : std::false_type {};
+template<class T, class S> struct has_on_exit<T, S, typename make_void<decltype(std::declval<T &>().on_exit(std::declval<S &>()))>::type> : std::true_type {};
+
+} // namespace vocab::detail
+
+template<class StateVariant, class EventVariant, class Transitions> class state_machine;
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+// state_machine - dispatch (state, event) pairs through a compile-time table of transitions //
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+// Transitions is a function object with an overload of operator()(S &, const E &) for each (state, event) pair
+// which the machine handles. An overload may return void, to remain in the current state, a value of one of the
+// state types, to transition to that state, or a std::variant<States...>, to transition to a state chosen at run
+// time. Pairs with no matching overload are ignored. Transitions may also provide on_entry(S &) and on_exit(S &)
+// overloads, which are called when the machine enters or leaves a state of type S.
+//
+// Each (state, event) pair is compiled into its own function, which calls the transition and hooks directly, and
+// these functions form a table indexed by (state index, event index). Processing an event is therefore a single
+// indirect call, rather than a visit over the state nested inside a visit over the event.
+template<class... States, class... Events, class Transitions> class state_machine<std::variant<States...>, std::variant<Events...>, Transitions>
+{
+public:
+    typedef std::variant<States...> state_type;
+    typedef std::variant<Events...> event_type;
+private:
+    typedef bool (* cell)(state_machine &, const void *);
+    constexpr static size_t state_count = sizeof...(States), event_count = sizeof...(Events);
+
+    Transitions _Transitions;
+    state_type _State;
+
+    template<class S> void _Enter(S & s, std::true_type) { _Transitions.on_entry(s); }
+    template<class S> void _Enter(S &, std::false_type) {}
+    template<class S> void _Exit(S & s, std::true_type) { _Transitions.on_exit(s); }
+    template<class S> void _Exit(S &, std::false_type) {}
+    template<class S> void _Enter(S & s) { _Enter(s, detail::has_on_entry<Transitions, S>{}); }
+    template<class S> void _Exit(S & s) { _Exit(s, detail::has_on_exit<Transitions, S>{}); }
+
+    template<class S, class E> bool _Apply(S &, const E &, detail::no_transition *) { return false; }
+    template<class S, class E> bool _Apply(S & s, const E & e, void *) { _Transitions(s, e); return true; }
+    template<class S, class E> bool _Apply(S & s, const E & e, state_type *)
+    {
+        state_type next = _Transitions(s, e);
+        _Exit(s);
+        _State = std::move(next);
+        std::visit([this](auto & n) { this->_Enter(n); }, _State);
+        return true;
+    }
+    template<class S, class E, class T> bool _Apply(S & s, const E & e, T *)
+    {
+        constexpr size_t I = std::_Early17::index_of<T, States...>::value;
+        T next = _Transitions(s, e);
+        _Exit(s);
+        _State.template emplace<I>(std::move(next));
+        _Enter(_State.template _Unchecked_get<I>());
+        return true;
+    }
+
+    template<size_t K> static bool _Cell(state_machine & m, const void * event)
+    {
+        typedef std::variant_alternative_t<K / event_count, state_type> S;
+        typedef std::variant_alternative_t<K % event_count, event_type> E;
+        typedef std::decay_t<typename detail::transition_result<Transitions, S, E>::type> R;
+        return m._Apply(m._State.template _Unchecked_get<K / event_count>(), *static_cast<const E *>(event), static_cast<R *>(nullptr));
+    }
+    template<size_t... K> static const cell * _Table(std::index_sequence<K...>)
+    {
+        static const cell table[] = {&_Cell<K>...};
+        return table;
+    }
+    static const cell * _Table() { return _Table(std::make_index_sequence<state_count * event_count>{}); }
+public:
+    // Construct a machine in its first state, or in the given state, and invoke the entry hook of that state
+    state_machine(Transitions transitions = Transitions{}) : state_machine(state_type{}, std::move(transitions)) {}
+    state_machine(state_type initial, Transitions transitions = Transitions{}) : _Transitions(std::move(transitions)), _State(std::move(initial)) { std::visit([this](auto & s) { this->_Enter(s); }, _State); }
+
+    const state_type & state() const { return _State; }
+    template<class S> bool is_in() const { return _State.index() == std::_Early17::index_of<S, States...>::value; }
+    Transitions & transitions() { return _Transitions; }
+    const Transitions & transitions() const { return _Transitions; }
+
+    // Process an event, returning false if the current state does not handle it. If a transition throws while moving
+    // the next state into place, the state is left valueless, and processing throws std::bad_variant_access from then
+    // on, as does processing a valueless event.
+    template<class E> bool process(const E & event)
+    {
+        if(_State.valueless_by_exception()) throw std::bad_variant_access{};
+        return _Table()[_State.index() * event_count + std::_Early17::index_of<E, Events...>::value](*this, &event);
+    }
+    bool process(const event_type & event)
+    {
+        if(_State.valueless_by_exception() || event.valueless_by_exception()) throw std::bad_variant_access{};
+        return _Table()[_State.index() * event_count + event.index()](*this, &event._Storage);
+    }
+};
+
+} // namespace vocab
+
+#endif
@@ -32,6 +32,7 @@
 #define EARLY17_STRING_VIEW
 
 #include <iterator>
+#include <ostream>
 #include <algorithm>
 #include <stdexcept>
 
@@ -285,8 +286,8 @@ public:
     // allocator to basic_string's constructor, but otherwise hopefully maintain reasonable compatibility.   //
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    // Instead of: basic_string<CharT, Traits>::operator basic_string_view<CharT, Traits>() const noexcept;
-    basic_string_view(const basic_string<CharT, Traits> & s) noexcept : basic_string_view{s.data(), s.size()} {}
+    // Instead of: basic_string<CharT, Traits, Allocator>::operator basic_string_view<CharT, Traits>() const noexcept;
+    template<class Allocator> basic_string_view(const basic_string<CharT, Traits, Allocator> & s) noexcept : basic_string_view{s.data(), s.size()} {}
 
     // Instead of: explicit basic_string::basic_string(basic_string_view<CharT, Traits> sv, const Allocator& alloc = Allocator());
     explicit operator basic_string<CharT, Traits>() const { return {data(), size()}; }
@@ -310,6 +311,22 @@ template< class CharT, class Traits > constexpr bool operator<=( basic_string_vi
 template< class CharT, class Traits > constexpr bool operator> ( basic_string_view <CharT,Traits> lhs, basic_string_view <CharT,Traits> rhs ) noexcept { return lhs.compare(rhs) >  0; } // (5)
 template< class CharT, class Traits > constexpr bool operator>=( basic_string_view <CharT,Traits> lhs, basic_string_view <CharT,Traits> rhs ) noexcept { return lhs.compare(rhs) >= 0; } // (6)
 
+// The "sufficient additional overloads" which allow one side to be any type convertible to basic_string_view, such as
+// basic_string or const CharT *. The other side still deduces CharT and Traits, as the identity_t side cannot.
+namespace _Early17 { template<class T> struct identity { typedef T type; }; template<class T> using identity_t = typename identity<T>::type; }
+template< class CharT, class Traits > constexpr bool operator==( basic_string_view <CharT,Traits> lhs, _Early17::identity_t<basic_string_view <CharT,Traits>> rhs ) noexcept { return lhs.compare(rhs) == 0; }
+template< class CharT, class Traits > constexpr bool operator!=( basic_string_view <CharT,Traits> lhs, _Early17::identity_t<basic_string_view <CharT,Traits>> rhs ) noexcept { return lhs.compare(rhs) != 0; }
+template< class CharT, class Traits > constexpr bool operator< ( basic_string_view <CharT,Traits> lhs, _Early17::identity_t<basic_string_view <CharT,Traits>> rhs ) noexcept { return lhs.compare(rhs) <  0; }
+template< class CharT, class Traits > constexpr bool operator<=( basic_string_view <CharT,Traits> lhs, _Early17::identity_t<basic_string_view <CharT,Traits>> rhs ) noexcept { return lhs.compare(rhs) <= 0; }
+template< class CharT, class Traits > constexpr bool operator> ( basic_string_view <CharT,Traits> lhs, _Early17::identity_t<basic_string_view <CharT,Traits>> rhs ) noexcept { return lhs.compare(rhs) >  0; }
+template< class CharT, class Traits > constexpr bool operator>=( basic_string_view <CharT,Traits> lhs, _Early17::identity_t<basic_string_view <CharT,Traits>> rhs ) noexcept { return lhs.compare(rhs) >= 0; }
+template< class CharT, class Traits > constexpr bool operator==( _Early17::identity_t<basic_string_view <CharT,Traits>> lhs, basic_string_view <CharT,Traits> rhs ) noexcept { return lhs.compare(rhs) == 0; }
+template< class CharT, class Traits > constexpr bool operator!=( _Early17::identity_t<basic_string_view <CharT,Traits>> lhs, basic_string_view <CharT,Traits> rhs ) noexcept { return lhs.compare(rhs) != 0; }
+template< class CharT, class Traits > constexpr bool operator< ( _Early17::identity_t<basic_string_view <CharT,Traits>> lhs, basic_string_view <CharT,Traits> rhs ) noexcept { return lhs.compare(rhs) <  0; }
+template< class CharT, class Traits > constexpr bool operator<=( _Early17::identity_t<basic_string_view <CharT,Traits>> lhs, basic_string_view <CharT,Traits> rhs ) noexcept { return lhs.compare(rhs) <= 0; }
+template< class CharT, class Traits > constexpr bool operator> ( _Early17::identity_t<basic_string_view <CharT,Traits>> lhs, basic_string_view <CharT,Traits> rhs ) noexcept { return lhs.compare(rhs) >  0; }
+template< class CharT, class Traits > constexpr bool operator>=( _Early17::identity_t<basic_string_view <CharT,Traits>> lhs, basic_string_view <CharT,Traits> rhs ) noexcept { return lhs.compare(rhs) >= 0; }
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // operator<< - http://en.cppreference.com/w/cpp/string/basic_string_view/operator_ltlt //
 //////////////////////////////////////////////////////////////////////////////////////////
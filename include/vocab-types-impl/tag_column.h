@@ -0,0 +1,179 @@
+// tag_column.h provides tag_column, a run-length encoded and bit-packed copy
+// of the index() sequence of a range of variants, and visit_runs, which
+// visits such a range one run of identical alternatives at a time. It is an
+// extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_TAG_COLUMN
+#define VOCAB_TYPES_TAG_COLUMN
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "variant.h"
+
+namespace vocab {
+
+namespace detail {
+
+constexpr unsigned ceil_log2(size_t n) { return n <= 1 ? 0 : 1 + ceil_log2((n + 1) / 2); }
+
+} // namespace vocab::detail
+
+/////////////////////////////////////////////////////////////////////////////
+// tag_column - run-length encoded, bit-packed sequence of variant indices //
+/////////////////////////////////////////////////////////////////////////////
+
+// Consecutive equal tags are stored as a single run. The tag of each run is packed into ceil(log2(N)) bits, and the
+// end of each run is stored as a 32-bit offset, which allows random access in O(log runs). A column in which runs
+// average more than 40 elements therefore costs less than one bit per element, compared to the eight bytes which
+// variant spends on its index. A column holds at most max_size() elements, and push_back throws std::length_error
+// rather than exceed it, or std::bad_variant_access for the index of a valueless variant.
+template<class Variant> class tag_column
+{
+public:
+    constexpr static size_t alternative_count = std::variant_size<Variant>::value;
+    constexpr static unsigned tag_bits = detail::ceil_log2(alternative_count) ? detail::ceil_log2(alternative_count) : 1;
+    static_assert(alternative_count <= 65536, "tag_column supports at most 65536 alternatives");
+
+    struct run { size_t tag, begin, end; };
+private:
+    constexpr static unsigned tags_per_word = 64 / tag_bits; // Tags never straddle two words
+    constexpr static uint64_t tag_mask = (1ull << tag_bits) - 1;
+
+    std::vector<uint64_t> _Tags; // Tag of each run, packed tags_per_word to a word
+    std::vector<uint32_t> _Ends; // One past the last element of each run
+
+    size_t _Run_tag(size_t r) const { return static_cast<size_t>(_Tags[r / tags_per_word] >> (r % tags_per_word * tag_bits) & tag_mask); }
+    size_t _Run_containing(size_t i) const { return static_cast<size_t>(std::upper_bound(_Ends.begin(), _Ends.end(), i) - _Ends.begin()); }
+public:
+    tag_column() = default;
+    template<class InputIt> tag_column(InputIt first, InputIt last) { for(; first != last; ++first) push_back(first->index()); }
+
+    // Number of elements, and number of runs
+    size_t size() const { return _Ends.empty() ? 0 : _Ends.back(); }
+    size_t run_count() const { return _Ends.size(); }
+    bool empty() const { return _Ends.empty(); }
+    constexpr static size_t max_size() { return UINT32_MAX; }
+
+    // Bytes of heap memory used to represent the column
+    size_t memory_usage() const { return _Tags.capacity() * sizeof(uint64_t) + _Ends.capacity() * sizeof(uint32_t); }
+
+    void push_back(size_t tag)
+    {
+        if(tag >= alternative_count) throw std::bad_variant_access{};
+        if(size() == max_size()) throw std::length_error("tag_column::push_back");
+        if(!_Ends.empty() && _Run_tag(_Ends.size() - 1) == tag) { ++_Ends.back(); return; }
+        const size_t r = _Ends.size();
+        if(r % tags_per_word == 0) _Tags.push_back(0);
+        _Tags.back() |= static_cast<uint64_t>(tag) << (r % tags_per_word * tag_bits);
+        _Ends.push_back(static_cast<uint32_t>(size() + 1));
+    }
+    void clear() { _Tags.clear(); _Ends.clear(); }
+    void shrink_to_fit() { _Tags.shrink_to_fit(); _Ends.shrink_to_fit(); }
+
+    // As with vector, i must be less than size(), and r less than run_count(), which is only checked by assertions
+    size_t operator[] (size_t i) const { assert(i < size()); return _Run_tag(_Run_containing(i)); }
+    run get_run(size_t r) const { assert(r < run_count()); return {_Run_tag(r), r ? _Ends[r - 1] : 0, _Ends[r]}; }
+
+    // Write the tags of elements [first, first + count) to out, one OutputInt per element. Each run is written with
+    // std::fill_n, which compilers lower to vectorized stores, so long runs decode at memory bandwidth. The range must
+    // lie within [0, size()), which is only checked by an assertion.
+    template<class OutputInt> void decode(size_t first, size_t count, OutputInt * out) const
+    {
+        assert(first <= size() && count <= size() - first);
+        const size_t last = first + count;
+        for(size_t r = _Run_containing(first); first < last; ++r)
+        {
+            const size_t n = std::min<size_t>(_Ends[r], last) - first;
+            out = std::fill_n(out, n, static_cast<OutputInt>(_Run_tag(r)));
+            first += n;
+        }
+    }
+
+    //////////////////////////////////////////////////////////
+    // run_iterator - iterate over the runs of a tag_column //
+    //////////////////////////////////////////////////////////
+
+    class run_iterator
+    {
+        const tag_column * _Column; size_t _Run;
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef run value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const run * pointer;
+        typedef run reference;
+
+        run_iterator(const tag_column * column, size_t r) : _Column{column}, _Run{r} {}
+        run operator * () const { return _Column->get_run(_Run); }
+        run_iterator & operator ++ () { ++_Run; return *this; }
+        run_iterator operator ++ (int) { auto r = *this; ++_Run; return r; }
+        bool operator == (const run_iterator & r) const { return _Run == r._Run; }
+        bool operator != (const run_iterator & r) const { return _Run != r._Run; }
+    };
+    struct run_range
+    {
+        run_iterator b, e;
+        run_iterator begin() const { return b; }
+        run_iterator end() const { return e; }
+    };
+    run_range runs() const { return {{this, 0}, {this, _Ends.size()}}; }
+};
+
+namespace detail {
+
+template<size_t I, class RandomIt, class Visitor> void visit_run(RandomIt first, RandomIt last, Visitor & vis) { for(; first != last; ++first) vis(first->template _Unchecked_get<I>()); }
+
+template<class RandomIt, class Visitor, size_t... I> void visit_run(size_t tag, RandomIt first, RandomIt last, Visitor & vis, std::index_sequence<I...>)
+{
+    static void (* const table[])(RandomIt, RandomIt, Visitor &) = {&visit_run<I, RandomIt, Visitor>...};
+    table[tag](first, last, vis);
+}
+
+} // namespace vocab::detail
+
+////////////////////////////////////////////////////////////////////////////////////////
+// visit_runs - visit a range of variants one run of identical alternatives at a time //
+////////////////////////////////////////////////////////////////////////////////////////
+
+// The alternative is resolved once per run of the tag column rather than once per element, and vis is then invoked
+// on each element of the run as that alternative, in a loop the compiler can specialize and vectorize. The tag column
+// must describe the range [first, first + tags.size()).
+template<class RandomIt, class Visitor> void visit_runs(const tag_column<typename std::iterator_traits<RandomIt>::value_type> & tags, RandomIt first, Visitor && vis)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type variant_type;
+    for(auto r : tags.runs()) detail::visit_run(r.tag, first + r.begin, first + r.end, vis, std::make_index_sequence<std::variant_size<variant_type>::value>{});
+}
+
+} // namespace vocab
+
+#endif
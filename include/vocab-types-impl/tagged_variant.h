@@ -0,0 +1,188 @@
+// tagged_variant.h provides tagged_variant, a variant whose alternatives are
+// identified by fixed wire tags rather than by position, for decoding tagged
+// protocol messages without a translation table. It is an extension to
+// vocab-types, and its permanent home is https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_TAGGED_VARIANT
+#define VOCAB_TYPES_TAGGED_VARIANT
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "variant.h"
+
+namespace vocab {
+
+// Associates the wire tag Tag with the alternative type T of a tagged_variant
+template<uint32_t Tag, class T> struct tag_v { constexpr static uint32_t tag = Tag; typedef T type; };
+
+namespace detail {
+
+template<uint32_t... Tags> struct max_tag : std::integral_constant<uint32_t, 0> {};
+template<uint32_t First, uint32_t... Rest> struct max_tag<First, Rest...> : std::integral_constant<uint32_t, (First > max_tag<Rest...>::value ? First : max_tag<Rest...>::value)> {};
+
+// Position of Tag within Tags..., or sizeof...(Tags) if it is not present
+template<uint32_t Tag, uint32_t... Tags> struct tag_position : std::integral_constant<size_t, 0> {};
+template<uint32_t Tag, uint32_t First, uint32_t... Rest> struct tag_position<Tag, First, Rest...> : std::integral_constant<size_t, Tag == First ? 0 : 1 + tag_position<Tag, Rest...>::value> {};
+
+template<uint32_t Tag, uint32_t... Tags> struct tag_count : std::integral_constant<size_t, 0> {};
+template<uint32_t Tag, uint32_t First, uint32_t... Rest> struct tag_count<Tag, First, Rest...> : std::integral_constant<size_t, (Tag == First) + tag_count<Tag, Rest...>::value> {};
+
+template<bool... B> struct bool_pack {};
+template<bool... B> struct all_of : std::is_same<bool_pack<true, B...>, bool_pack<B..., true>> {};
+template<class T, class... Types> struct is_one_of : std::integral_constant<bool, !all_of<!std::is_same<T, Types>::value...>::value> {};
+
+// A table mapping every tag from 0 to the largest tag to its position, built entirely from constants, so that it
+// is statically initialized
+template<class Position, uint32_t... Tags> struct dense_tag_table
+{
+    template<size_t... T> static const Position * get(std::index_sequence<T...>)
+    {
+        static const Position table[] = {static_cast<Position>(tag_position<static_cast<uint32_t>(T), Tags...>::value)...};
+        return table;
+    }
+    static const Position * get() { return get(std::make_index_sequence<max_tag<Tags...>::value + 1>{}); }
+};
+
+} // namespace vocab::detail
+
+///////////////////////////////////////////////////////////////////////////////
+// tagged_variant - variant whose index() is the wire tag of its alternative //
+///////////////////////////////////////////////////////////////////////////////
+
+// A tagged_variant<tag_v<0x10, A>, tag_v<0x22, B>, ...> holds a std::variant<A, B, ...>, and translates between its
+// positions and the wire tags at compile time wherever the tag is known statically. Where the tag is only known at
+// run time, as when decoding a message header, position_of(tag) is a single lookup in a dense table indexed by tag,
+// provided the largest tag is below dense_limit, and a linear search of the tags otherwise. emplace_tag and visit
+// then dispatch through tables of functions indexed by position.
+template<class... Tagged> class tagged_variant
+{
+    static_assert(detail::all_of<(detail::tag_count<Tagged::tag, Tagged::tag...>::value == 1)...>::value, "the tags of a tagged_variant must be distinct");
+public:
+    typedef std::variant<typename Tagged::type...> variant_type;
+    constexpr static size_t alternative_count = sizeof...(Tagged);
+    constexpr static uint32_t npos = ~uint32_t(0);
+    constexpr static uint32_t dense_limit = 1024;
+private:
+    constexpr static uint32_t _Max_tag = detail::max_tag<Tagged::tag...>::value;
+    typedef std::conditional_t<(alternative_count < 255), uint8_t, uint16_t> _Position;
+
+    static const uint32_t * _Tags() { static const uint32_t tags[] = {Tagged::tag...}; return tags; }
+    static size_t _Position_of(uint32_t tag, std::true_type) { return tag <= _Max_tag ? detail::dense_tag_table<_Position, Tagged::tag...>::get()[tag] : alternative_count; }
+    static size_t _Position_of(uint32_t tag, std::false_type)
+    {
+        for(size_t i=0; i<alternative_count; ++i) if(_Tags()[i] == tag) return i;
+        return alternative_count;
+    }
+
+    template<size_t I, class... Args> static void _Emplace(variant_type & v, Args &&... args) { v.template emplace<I>(std::forward<Args>(args)...); }
+    template<class... Args, size_t... I> void _Emplace_at(size_t position, std::index_sequence<I...>, Args &&... args)
+    {
+        static void (* const table[])(variant_type &, Args &&...) = {&_Emplace<I, Args...>...};
+        table[position](_Variant, std::forward<Args>(args)...);
+    }
+public:
+    template<uint32_t Tag> using alternative_t = std::variant_alternative_t<detail::tag_position<Tag, Tagged::tag...>::value, variant_type>;
+
+    // The position of the alternative with the given tag, or alternative_count if there is none
+    static size_t position_of(uint32_t tag) noexcept { return _Position_of(tag, std::integral_constant<bool, (_Max_tag < dense_limit)>{}); }
+    static bool has_tag(uint32_t tag) noexcept { return position_of(tag) != alternative_count; }
+    static uint32_t tag_at(size_t position) noexcept { return position < alternative_count ? _Tags()[position] : npos; }
+
+    tagged_variant() = default;
+    template<class T, class = std::enable_if_t<detail::is_one_of<std::decay_t<T>, typename Tagged::type...>::value>> tagged_variant(T && value) : _Variant(std::in_place<std::_Early17::index_of<std::decay_t<T>, typename Tagged::type...>::value>, std::forward<T>(value)) {}
+
+    // The wire tag of the held alternative, or npos if the variant is valueless
+    uint32_t index() const noexcept { return _Variant.valueless_by_exception() ? npos : _Tags()[_Variant.index()]; }
+    size_t position() const noexcept { return _Variant.index(); }
+    bool valueless_by_exception() const noexcept { return _Variant.valueless_by_exception(); }
+    const variant_type & variant() const noexcept { return _Variant; }
+
+    template<uint32_t Tag, class... Args> alternative_t<Tag> & emplace(Args &&... args)
+    {
+        constexpr size_t I = detail::tag_position<Tag, Tagged::tag...>::value;
+        _Variant.template emplace<I>(std::forward<Args>(args)...);
+        return _Variant.template _Unchecked_get<I>();
+    }
+    template<class T, class... Args> T & emplace(Args &&... args)
+    {
+        constexpr size_t I = std::_Early17::index_of<T, typename Tagged::type...>::value;
+        _Variant.template emplace<I>(std::forward<Args>(args)...);
+        return _Variant.template _Unchecked_get<I>();
+    }
+
+    // Construct the alternative with the given run-time tag from args, returning false if the tag is unknown. Every
+    // alternative must be constructible from args.
+    template<class... Args> bool emplace_tag(uint32_t tag, Args &&... args)
+    {
+        const size_t position = position_of(tag);
+        if(position == alternative_count) return false;
+        _Emplace_at(position, std::make_index_sequence<alternative_count>{}, std::forward<Args>(args)...);
+        return true;
+    }
+
+    void swap(tagged_variant & r) { _Variant.swap(r._Variant); }
+//private:
+    variant_type _Variant;
+};
+template<class... Tagged> constexpr size_t tagged_variant<Tagged...>::alternative_count;
+template<class... Tagged> constexpr uint32_t tagged_variant<Tagged...>::npos;
+template<class... Tagged> constexpr uint32_t tagged_variant<Tagged...>::dense_limit;
+
+template<class... Tagged> bool operator == (const tagged_variant<Tagged...> & a, const tagged_variant<Tagged...> & b) { return a.variant() == b.variant(); }
+template<class... Tagged> bool operator != (const tagged_variant<Tagged...> & a, const tagged_variant<Tagged...> & b) { return a.variant() != b.variant(); }
+
+template<uint32_t Tag, class... Tagged> bool holds_tag(const tagged_variant<Tagged...> & v) noexcept { return v.index() == Tag; }
+
+// get and get_if take the wire tag of the alternative, in place of its position
+template<uint32_t Tag, class... Tagged> auto & get(tagged_variant<Tagged...> & v) { return std::get<detail::tag_position<Tag, Tagged::tag...>::value>(v._Variant); }
+template<uint32_t Tag, class... Tagged> auto & get(const tagged_variant<Tagged...> & v) { return std::get<detail::tag_position<Tag, Tagged::tag...>::value>(v._Variant); }
+template<uint32_t Tag, class... Tagged> auto get_if(tagged_variant<Tagged...> * v) noexcept { return std::get_if<detail::tag_position<Tag, Tagged::tag...>::value>(v ? &v->_Variant : nullptr); }
+template<uint32_t Tag, class... Tagged> auto get_if(const tagged_variant<Tagged...> * v) noexcept { return std::get_if<detail::tag_position<Tag, Tagged::tag...>::value>(v ? &v->_Variant : nullptr); }
+
+namespace detail {
+
+template<size_t I, class Visitor, class Variant> auto visit_tagged(Visitor & vis, Variant & v) -> decltype(vis(v.template _Unchecked_get<0>())) { return vis(v.template _Unchecked_get<I>()); }
+
+template<class Visitor, class Variant, size_t... I> auto visit_tagged(Visitor & vis, Variant & v, std::index_sequence<I...>)
+{
+    typedef decltype(vis(v.template _Unchecked_get<0>())) result_type;
+    static result_type (* const table[])(Visitor &, Variant &) = {&visit_tagged<I, Visitor, Variant>...};
+    if(v.valueless_by_exception()) throw std::bad_variant_access{};
+    return table[v.index()](vis, v);
+}
+
+} // namespace vocab::detail
+
+// Invoke vis with the held alternative, through a table indexed by position
+template<class Visitor, class... Tagged> auto visit(Visitor && vis, tagged_variant<Tagged...> & v) { return detail::visit_tagged(vis, v._Variant, std::make_index_sequence<sizeof...(Tagged)>{}); }
+template<class Visitor, class... Tagged> auto visit(Visitor && vis, const tagged_variant<Tagged...> & v) { return detail::visit_tagged(vis, v._Variant, std::make_index_sequence<sizeof...(Tagged)>{}); }
+
+} // namespace vocab
+
+#endif
@@ -54,6 +54,17 @@ using in_place_t = in_place_tag (&)();
 template<class T> using in_place_type_t = in_place_tag (&)(_Early17::tag_t<T>);
 template<size_t I> using in_place_index_t = in_place_tag (&)(_Early17::index_t<I>);
 
+///////////////////////////////////////////////////////////////////////////////////
+// in_place_from - construct from the result of an invocable (not part of C++17) //
+///////////////////////////////////////////////////////////////////////////////////
+
+// Passing in_place_from and an invocable f to a constructor of variant, optional or any, or f to their emplace_from
+// members, initializes the contained value directly from the prvalue returned by f(), so that a value returned from
+// a factory function is constructed in place. C++17 guarantees this elision. C++14 only permits it, and requires the
+// type to be move constructible, but all supported compilers perform it.
+struct in_place_from_t { constexpr explicit in_place_from_t() {} };
+constexpr in_place_from_t in_place_from {};
+
 } // namespace std
 
 #endif
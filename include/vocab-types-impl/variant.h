@@ -138,6 +138,8 @@ public:
     template<class T, class U, class... Args > explicit variant(in_place_type_t<T>, initializer_list<U> il, Args&&... args)     { emplace<T>(il, std::forward<Args>(args)...); } // (6)
     template<size_t I, class... Args> explicit variant(in_place_index_t<I>, Args&&... args)                                     { emplace<I>(std::forward<Args>(args)...); } // (7)
     template<size_t I, class U, class... Args> explicit variant(in_place_index_t<I>, initializer_list<U> il, Args&&... args)    { emplace<I>(il, std::forward<Args>(args)...); } // (8)
+    template<class T, class F> explicit variant(in_place_type_t<T>, in_place_from_t, F && f)                                   { emplace_from<T>(std::forward<F>(f)); } // (extension)
+    template<size_t I, class F> explicit variant(in_place_index_t<I>, in_place_from_t, F && f)                                 { emplace_from<I>(std::forward<F>(f)); } // (extension)
 
     ////////////////////////////////////////////////////////////////////////////////
     // (destructor) - http://en.cppreference.com/w/cpp/utility/variant/%7Evariant //
@@ -195,6 +197,11 @@ public:
     template<size_t I, class... Args> void emplace(Args&&... args) { _Reset(); new(&_Storage) variant_alternative_t<I, variant>(std::forward<Args>(args)...); _Index = I; }                                             // (3)
     template<size_t I, class U, class... Args> void emplace(std::initializer_list<U> il, Args&&... args) { _Reset(); new(&_Storage) variant_alternative_t<I, variant>(il, std::forward<Args>(args)...); _Index = I; }   // (4)
 
+    // Destroy the current value, then construct alternative I directly from the prvalue returned by f(). As with
+    // emplace, f must not refer to the current value, and the variant is left valueless if f() throws.
+    template<class T, class F> T & emplace_from(F && f) { return emplace_from<_Early17::index_of<T, Types...>::value>(std::forward<F>(f)); }                                                                         // (extension)
+    template<size_t I, class F> variant_alternative_t<I, variant> & emplace_from(F && f) { _Reset(); new(&_Storage) variant_alternative_t<I, variant>(std::forward<F>(f)()); _Index = I; return _Unchecked_get<I>(); } // (extension)
+
     //////////////////////////////////////////////////////////////////
     // swap - http://en.cppreference.com/w/cpp/utility/variant/swap //
     //////////////////////////////////////////////////////////////////
@@ -214,8 +221,8 @@ public:
         }
     }
 
-    //template<size_t I> variant_alternative_t<I, variant> & _Unchecked_get() noexcept { return reinterpret_cast<variant_alternative_t<I, variant> &>(_Storage); }
-    //template<size_t I> variant_alternative_t<I, variant> const & _Unchecked_get() const noexcept { return reinterpret_cast<variant_alternative_t<I, variant> const &>(_Storage); }
+    template<size_t I> variant_alternative_t<I, variant> & _Unchecked_get() noexcept { return reinterpret_cast<variant_alternative_t<I, variant> &>(_Storage); }
+    template<size_t I> variant_alternative_t<I, variant> const & _Unchecked_get() const noexcept { return reinterpret_cast<variant_alternative_t<I, variant> const &>(_Storage); }
 //private:
     void _Reset()
     {
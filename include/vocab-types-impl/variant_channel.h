@@ -0,0 +1,193 @@
+// variant_channel.h provides variant_channel, a bounded lock-free queue of
+// variant messages which are constructed and visited in place. It is an
+// extension to vocab-types, and its permanent home is
+// https://github.com/sgorsten/vocab-types
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_VARIANT_CHANNEL
+#define VOCAB_TYPES_VARIANT_CHANNEL
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include "variant.h"
+
+namespace vocab {
+
+////////////////////////////////////////////////////////////////////////////////
+// variant_channel - bounded multi-producer, multi-consumer queue of variants //
+////////////////////////////////////////////////////////////////////////////////
+
+// The channel is a ring of slots, each holding a sequence number and storage for one variant, as
+// described by Dmitry Vyukov's bounded MPMC queue. Producers claim a slot by advancing the enqueue
+// position, construct the message directly in the slot, and publish it by advancing the slot's
+// sequence number. Consumers visit the message where it lies and destroy it before releasing the slot.
+// The same algorithm serves single-producer, single-consumer use without modification.
+template<class... Types> class variant_channel
+{
+public:
+    typedef std::variant<Types...> value_type;
+private:
+    struct slot
+    {
+        std::atomic<size_t> sequence;
+        bool valueless;
+        std::aligned_storage_t<sizeof(value_type), alignof(value_type)> storage;
+        value_type & value() { return reinterpret_cast<value_type &>(storage); }
+    };
+
+    // Pad the positions onto separate cache lines so that producers and consumers do not contend
+    char _Pad0[64];
+    std::atomic<size_t> _Enqueue_pos {0};
+    char _Pad1[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> _Dequeue_pos {0};
+    char _Pad2[64 - sizeof(std::atomic<size_t>)];
+    size_t _Mask;
+    std::unique_ptr<slot[]> _Slots;
+
+    static size_t _Round_up(size_t n) { size_t p = 2; while(p < n) p *= 2; return p; }
+
+    slot * _Claim_for_write()
+    {
+        for(size_t pos = _Enqueue_pos.load(std::memory_order_relaxed); ; )
+        {
+            slot & s = _Slots[pos & _Mask];
+            const auto diff = static_cast<std::ptrdiff_t>(s.sequence.load(std::memory_order_acquire) - pos);
+            if(diff == 0) { if(_Enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &s; }
+            else if(diff < 0) return nullptr;
+            else pos = _Enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Claims up to max_count consecutive published slots, returning the position of the first and the number claimed
+    size_t _Claim_for_read(size_t max_count, size_t & first)
+    {
+        for(size_t pos = _Dequeue_pos.load(std::memory_order_relaxed); ; )
+        {
+            size_t count = 0;
+            while(count < max_count && _Slots[(pos + count) & _Mask].sequence.load(std::memory_order_acquire) == pos + count + 1) ++count;
+            if(count == 0)
+            {
+                if(static_cast<std::ptrdiff_t>(_Slots[pos & _Mask].sequence.load(std::memory_order_acquire) - (pos + 1)) < 0) return 0;
+                pos = _Dequeue_pos.load(std::memory_order_relaxed);
+            }
+            else if(_Dequeue_pos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) { first = pos; return count; }
+        }
+    }
+
+    // Visits and destroys the message at pos, returning false if its slot was left empty by a throwing constructor
+    template<class Visitor> bool _Consume(size_t pos, Visitor & vis)
+    {
+        struct release
+        {
+            slot & s; size_t next;
+            ~release() { if(!s.valueless) s.value().~value_type(); s.sequence.store(next, std::memory_order_release); }
+        } guard {_Slots[pos & _Mask], pos + _Mask + 1};
+        if(guard.s.valueless) return false;
+        std::visit(vis, guard.s.value());
+        return true;
+    }
+
+    template<class Construct> bool _Try_construct(Construct && construct)
+    {
+        slot * s = _Claim_for_write();
+        if(!s) return false;
+        const size_t next = s->sequence.load(std::memory_order_relaxed) + 1;
+        try
+        {
+            construct(&s->storage);
+            s->valueless = false;
+        }
+        catch(...)
+        {
+            // The slot has already been claimed, so publish it as empty, and consumers will skip over it
+            s->valueless = true;
+            s->sequence.store(next, std::memory_order_release);
+            throw;
+        }
+        s->sequence.store(next, std::memory_order_release);
+        return true;
+    }
+public:
+    // Constructs a channel which can hold at least capacity messages (rounded up to a power of two)
+    explicit variant_channel(size_t capacity) : _Mask{_Round_up(capacity) - 1}, _Slots{new slot[_Mask + 1]}
+    {
+        for(size_t i=0; i<=_Mask; ++i) _Slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    variant_channel(const variant_channel &) = delete;
+    variant_channel & operator = (const variant_channel &) = delete;
+    ~variant_channel() { while(try_receive([](auto &&) {})) {} }
+
+    size_t capacity() const { return _Mask + 1; }
+
+    // Construct a message of alternative T or I directly in the next free slot, returning false if the channel is full
+    // Arguments are only forwarded once a slot has been claimed, so the blocking overloads may safely retry with the same arguments
+    template<size_t I, class... Args> bool try_emplace(Args &&... args) { return _Try_construct([&](void * p) { new(p) value_type(std::in_place<I>, std::forward<Args>(args)...); }); }
+    template<class T, class... Args> bool try_emplace(Args &&... args) { return try_emplace<std::_Early17::index_of<T, Types...>::value>(std::forward<Args>(args)...); }
+    template<size_t I, class... Args> void emplace(Args &&... args) { while(!try_emplace<I>(std::forward<Args>(args)...)) std::this_thread::yield(); }
+    template<class T, class... Args> void emplace(Args &&... args) { while(!try_emplace<T>(std::forward<Args>(args)...)) std::this_thread::yield(); }
+
+    // Copy or move an existing variant into the next free slot, returning false if the channel is full
+    template<class V> std::enable_if_t<std::is_same<std::decay_t<V>, value_type>::value, bool> try_push(V && v) { return _Try_construct([&](void * p) { new(p) value_type(std::forward<V>(v)); }); }
+    template<class V> std::enable_if_t<std::is_same<std::decay_t<V>, value_type>::value> push(V && v) { while(!try_push(std::forward<V>(v))) std::this_thread::yield(); }
+
+    // Visit the oldest message in place and then destroy it, returning false if the channel is empty. Slots left
+    // empty by a producer whose constructor threw are released and skipped.
+    template<class Visitor> bool try_receive(Visitor && vis)
+    {
+        for(size_t pos; _Claim_for_read(1, pos); )
+        {
+            if(_Consume(pos, vis)) return true;
+        }
+        return false;
+    }
+    template<class Visitor> void receive(Visitor && vis) { while(!try_receive(vis)) std::this_thread::yield(); }
+
+    // Claim up to max_count of the oldest messages at once, then visit and destroy each in order, returning the number
+    // claimed, which includes any slots left empty by a throwing constructor, as those are not visited
+    template<class Visitor> size_t try_receive_batch(Visitor && vis, size_t max_count)
+    {
+        size_t pos, count = _Claim_for_read(max_count, pos), i = 0;
+        try
+        {
+            for(; i<count; ++i) _Consume(pos + i, vis);
+        }
+        catch(...)
+        {
+            // The remaining messages have already been claimed, and must be released so that the ring can advance
+            auto discard = [](auto &&) {};
+            while(++i < count) _Consume(pos + i, discard);
+            throw;
+        }
+        return count;
+    }
+};
+
+} // namespace vocab
+
+#endif
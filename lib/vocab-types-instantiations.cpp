@@ -0,0 +1,4 @@
+// Defines the explicit instantiations declared extern by vocab-types-instantiations.h
+#include "vocab-types-instantiations.h"
+
+VOCAB_INSTANTIATE_TEMPLATES(VOCAB_TYPES_INSTANTIATION_LIST)
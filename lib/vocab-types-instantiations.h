@@ -0,0 +1,51 @@
+// vocab-types-instantiations.h lists the instantiations of std::optional and
+// std::variant which are compiled once into libvocab-types.a, and declares them
+// extern. Edit VOCAB_TYPES_INSTANTIATION_LIST to list the types your program uses,
+// and include this header, or pass it to the compiler with -include, in every
+// translation unit which is linked against the library.
+
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+
+#ifndef VOCAB_TYPES_INSTANTIATIONS
+#define VOCAB_TYPES_INSTANTIATIONS
+
+#include <string>
+#include <explicit_instantiation>
+
+#define VOCAB_TYPES_INSTANTIATION_LIST(OPTIONAL, VARIANT) \
+    OPTIONAL(bool) \
+    OPTIONAL(int) \
+    OPTIONAL(float) \
+    OPTIONAL(double) \
+    OPTIONAL(std::string) \
+    VARIANT(bool, float) \
+    VARIANT(int, double) \
+    VARIANT(int, std::string) \
+    VARIANT(int, double, std::string)
+
+VOCAB_EXTERN_TEMPLATES(VOCAB_TYPES_INSTANTIATION_LIST)
+
+#endif
@@ -1,5 +1,6 @@
 #include <any>
 #include "doctest.h"
+#include "test-payload.h"
 #include <string>
 
 TEST_CASE("construct std::any")
@@ -27,4 +28,20 @@ TEST_CASE("construct std::any")
     CHECK(d.type() == typeid(double));
     CHECK(std::any_cast<double>(&d) != nullptr);
     CHECK(std::any_cast<double>(d) == 3.14);
+}
+
+TEST_CASE("any emplace_from constructs from a factory result in place")
+{
+    test_big_payload::copies_and_moves() = 0;
+    std::any a {std::in_place_from, []() { return test_big_payload{'a'}; }};
+    CHECK(a.type() == typeid(test_big_payload));
+    CHECK(std::any_cast<test_big_payload>(&a)->bytes[0] == 'a');
+
+    auto & p = a.emplace_from([]() { return test_big_payload{'b'}; });
+    CHECK(&p == std::any_cast<test_big_payload>(&a));
+    CHECK(p.bytes[4095] == 'b');
+    CHECK(test_big_payload::copies_and_moves() == 0);
+
+    CHECK(a.emplace_from([]() { return std::string{"text"}; }) == "text");
+    CHECK(a.type() == typeid(std::string));
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include <atomic_variant>
+#include "doctest.h"
+#include <thread>
+#include <vector>
+
+struct idle {};
+struct running { int pid; };
+struct failed { int code; };
+struct config { int a, b, c, d, e; };
+
+TEST_CASE("atomic_variant load, store, and compare_exchange")
+{
+    vocab::atomic_variant<idle, running, failed> state;
+    CHECK(decltype(state)::is_lock_free());
+    CHECK(state.load().index() == 0);
+
+    state.store(running{42});
+    auto snapshot = state.load();
+    REQUIRE(snapshot.index() == 1);
+    CHECK(std::get<running>(snapshot).pid == 42);
+
+    std::variant<idle, running, failed> expected {idle{}};
+    CHECK(!state.compare_exchange(expected, failed{1}));
+    REQUIRE(expected.index() == 1);
+    CHECK(std::get<running>(expected).pid == 42);
+
+    CHECK(state.compare_exchange(expected, failed{7}));
+    CHECK(state.visit_snapshot([](const auto & x) { return sizeof(x); }) == sizeof(failed));
+    CHECK(std::get<failed>(state.load()).code == 7);
+}
+
+TEST_CASE("atomic_optional load, store, and compare_exchange")
+{
+    vocab::atomic_optional<int> a;
+    CHECK(decltype(a)::is_lock_free());
+    CHECK(!a.load());
+
+    std::optional<int> expected;
+    CHECK(a.compare_exchange(expected, 5));
+    CHECK(a.load() == 5);
+    CHECK(!a.compare_exchange(expected, 6));
+    CHECK(expected == 5);
+    CHECK(a.visit_snapshot([](const std::optional<int> & x) { return x.value_or(0); }) == 5);
+
+    a.store(std::nullopt);
+    CHECK(!a.load());
+
+    vocab::atomic_optional<config> b {config{1,1,1,1,1}};
+    CHECK(!decltype(b)::is_lock_free());
+    CHECK(b.load()->e == 1);
+}
+
+TEST_CASE("atomic_variant compare_exchange loops are linearizable")
+{
+    vocab::atomic_variant<idle, running> counter {running{0}};
+    std::vector<std::thread> threads;
+    for(int i=0; i<4; ++i) threads.emplace_back([&counter]()
+    {
+        for(int j=0; j<1000; ++j)
+        {
+            auto expected = counter.load();
+            while(!counter.compare_exchange(expected, running{std::get<running>(expected).pid + 1})) {}
+        }
+    });
+    for(auto & t : threads) t.join();
+    CHECK(std::get<running>(counter.load()).pid == 4000);
+}
+
+TEST_CASE("atomic_optional readers never observe torn writes")
+{
+    vocab::atomic_optional<config> shared {config{0,0,0,0,0}};
+    std::atomic<bool> done {false};
+    std::atomic<int> torn {0};
+    std::thread reader([&]()
+    {
+        while(!done)
+        {
+            const config c = *shared.load();
+            if(c.a != c.b || c.a != c.c || c.a != c.d || c.a != c.e) ++torn;
+        }
+    });
+    for(int i=1; i<=10000; ++i) shared.store(config{i,i,i,i,i});
+    done = true;
+    reader.join();
+    CHECK(torn == 0);
+    CHECK(shared.load()->e == 10000);
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include <compact_optional>
+#include "doctest.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class compact_color { red, green, blue, none };
+
+TEST_CASE("compact_optional is exactly the size of its value type")
+{
+    CHECK(sizeof(vocab::compact_optional<int32_t, vocab::sentinel_value<int32_t, -1>>) == 4);
+    CHECK(sizeof(vocab::compact_optional<double, vocab::nan_sentinel<double>>) == 8);
+    CHECK(sizeof(vocab::compact_optional<compact_color, vocab::sentinel_value<compact_color, compact_color::none>>) == sizeof(compact_color));
+    CHECK(sizeof(vocab::compact_optional<int *, vocab::sentinel_value<int *, nullptr>>) == sizeof(int *));
+    CHECK((std::is_trivially_copyable<vocab::compact_optional<int32_t, vocab::sentinel_value<int32_t, -1>>>::value));
+}
+
+TEST_CASE("compact_optional has the interface of std::optional")
+{
+    typedef vocab::compact_optional<int, vocab::sentinel_value<int, -1>> index;
+    index a, b {7}, c {std::nullopt};
+    CHECK(!a);
+    CHECK(!a.has_value());
+    CHECK(b.has_value());
+    CHECK(*b == 7);
+    CHECK(b.value() == 7);
+    CHECK(c == std::nullopt);
+    CHECK_THROWS_AS(a.value(), const std::bad_optional_access &);
+    CHECK(a.value_or(3) == 3);
+    CHECK(b.value_or(3) == 7);
+
+    a = 5;
+    CHECK(a == 5);
+    CHECK(a.emplace(9) == 9);
+    a.swap(c);
+    CHECK(!a);
+    CHECK(c == 9);
+    c.reset();
+    CHECK(!c);
+    c = 2;
+    c = std::nullopt;
+    CHECK(!c);
+
+    const std::optional<int> o = b;
+    CHECK(o == 7);
+    CHECK(index{std::optional<int>{}} == std::nullopt);
+    CHECK(index{std::optional<int>{4}} == 4);
+
+    vocab::compact_optional<double, vocab::nan_sentinel<double>> d;
+    CHECK(!d);
+    CHECK(std::isnan(*d));
+    d = 2.5;
+    CHECK(d == 2.5);
+    CHECK(d.value_or(1.0) == 2.5);
+}
+
+TEST_CASE("compact_optional compares and hashes like std::optional")
+{
+    typedef vocab::compact_optional<int, vocab::sentinel_value<int, -1>> index;
+    std::vector<index> values {index{}, index{0}, index{3}, index{8}};
+    std::vector<std::optional<int>> reference {std::nullopt, 0, 3, 8};
+    for(size_t i=0; i<values.size(); ++i)
+    {
+        CHECK(std::hash<index>{}(values[i]) == std::hash<std::optional<int>>{}(reference[i]));
+        CHECK((values[i] == std::nullopt) == (reference[i] == std::nullopt));
+        CHECK((values[i] < 3) == (reference[i] < 3));
+        CHECK((3 >= values[i]) == (3 >= reference[i]));
+        for(size_t j=0; j<values.size(); ++j)
+        {
+            CHECK((values[i] == values[j]) == (reference[i] == reference[j]));
+            CHECK((values[i] != values[j]) == (reference[i] != reference[j]));
+            CHECK((values[i] < values[j]) == (reference[i] < reference[j]));
+            CHECK((values[i] <= values[j]) == (reference[i] <= reference[j]));
+            CHECK((values[i] > values[j]) == (reference[i] > reference[j]));
+            CHECK((values[i] >= values[j]) == (reference[i] >= reference[j]));
+        }
+    }
+    CHECK(index{3} == 3L);
+    CHECK(index{3} == std::optional<int>{3});
+    CHECK(std::optional<int>{} == index{});
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include <cow_variant>
+#include "doctest.h"
+#include "test-payload.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+struct cow_route
+{
+    test_counted a;
+    int b;
+    cow_route(int a, int b) : a{a}, b{b} {}
+};
+
+TEST_CASE("cow_variant snapshots are unaffected by later writes")
+{
+    vocab::cow_variant<int, std::string> flags {std::string{"initial"}};
+    auto before = flags.read();
+    CHECK(std::get<std::string>(*before) == "initial");
+
+    flags.store(42);
+    auto after = flags.read();
+    CHECK(std::get<std::string>(*before) == "initial");
+    CHECK(std::get<int>(*after) == 42);
+
+    flags.update([](std::variant<int, std::string> & v) { std::get<int>(v) += 1; });
+    CHECK(flags.visit([](const auto & x) { return sizeof(x) == sizeof(int); }));
+    CHECK(std::get<int>(*flags.read()) == 43);
+    CHECK(std::get<int>(*after) == 42);
+}
+
+TEST_CASE("cow_variant reclaims every version")
+{
+    {
+        vocab::cow_variant<std::monostate, cow_route> table {std::monostate{}, 8};
+        std::atomic<bool> done {false};
+        std::atomic<int> torn {0};
+        struct checker
+        {
+            std::atomic<int> & torn;
+            void operator() (std::monostate) const {}
+            void operator() (const cow_route & r) const { if(r.a.value != r.b) ++torn; }
+        };
+        std::vector<std::thread> readers;
+        for(int i=0; i<4; ++i) readers.emplace_back([&]() { while(!done) table.visit(checker{torn}); });
+        for(int i=0; i<2000; ++i) table.emplace<cow_route>(i, i);
+        done = true;
+        for(auto & t : readers) t.join();
+        CHECK(torn == 0);
+
+        table.reclaim();
+        CHECK(test_counted::live() == 1);
+    }
+    CHECK(test_counted::live() == 0);
+}
+
+TEST_CASE("cow_variant copies the current version when every reader slot is taken")
+{
+    {
+        vocab::cow_variant<std::monostate, cow_route> table {cow_route{1, 1}, 2};
+        auto a = table.read();
+        auto b = table.read();
+        auto c = table.read();
+        CHECK(&*a == &*b);
+        CHECK(&*c != &*a);
+        CHECK(std::get<cow_route>(*c).a.value == 1);
+        CHECK(test_counted::live() == 2);
+
+        table.emplace<cow_route>(2, 2);
+        auto d = std::move(c);
+        CHECK(std::get<cow_route>(*d).a.value == 1);
+        CHECK(std::get<cow_route>(*a).a.value == 1);
+        CHECK(std::get<cow_route>(*table.read()).a.value == 2);
+    }
+    CHECK(test_counted::live() == 0);
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <expected>
+#include "doctest.h"
+#include "test-payload.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class parse_error { empty, not_a_number, overflow };
+
+std::expected<int, parse_error> parse_digits(const std::string & s)
+{
+    if(s.empty()) return std::make_unexpected(parse_error::empty);
+    int value = 0;
+    for(char c : s)
+    {
+        if(c < '0' || c > '9') return std::make_unexpected(parse_error::not_a_number);
+        if(value > 100000000) return std::make_unexpected(parse_error::overflow);
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+TEST_CASE("expected holds a value or an error")
+{
+    CHECK((std::is_trivially_copyable<std::expected<int, parse_error>>::value));
+    CHECK((std::is_trivially_destructible<std::expected<int, parse_error>>::value));
+    CHECK(sizeof(std::expected<int, parse_error>) == 8);
+    CHECK((!std::is_trivially_copyable<std::expected<std::string, int>>::value));
+
+    auto a = parse_digits("42");
+    REQUIRE(a.has_value());
+    CHECK(*a == 42);
+    CHECK(a.value() == 42);
+    CHECK(a == 42);
+    CHECK(a.error_or(parse_error::empty) == parse_error::empty);
+
+    auto b = parse_digits("4x2");
+    REQUIRE(!b);
+    CHECK(b.error() == parse_error::not_a_number);
+    CHECK(b == std::make_unexpected(parse_error::not_a_number));
+    CHECK(b.value_or(-1) == -1);
+    CHECK_THROWS_AS(b.value(), const std::bad_expected_access<parse_error> &);
+    CHECK(a != b);
+
+    b = 7;
+    CHECK(b == 7);
+    b = std::make_unexpected(parse_error::overflow);
+    CHECK(b.error() == parse_error::overflow);
+}
+
+TEST_CASE("expected with non-trivial alternatives")
+{
+    std::expected<std::string, std::string> a {std::in_place, 3, 'x'};
+    CHECK(*a == "xxx");
+    std::expected<std::string, std::string> b {std::unexpect, "bad"};
+    CHECK(b.error() == "bad");
+
+    auto c = a;
+    CHECK(c == a);
+    c = b;
+    CHECK(!c);
+    CHECK(c.error() == "bad");
+    c.emplace("ok");
+    CHECK(*c == "ok");
+    swap(b, c);
+    CHECK(*b == "ok");
+    CHECK(c.error() == "bad");
+}
+
+// Counts live instances, and throws from its constructors when asked to, so that a destroyed alternative which is
+// still named by an expected would show up as a second destruction
+struct expected_fragile : test_counted
+{
+    static bool throws;
+    expected_fragile(int value) : test_counted{value} { if(throws) throw std::runtime_error("construct"); }
+    expected_fragile(const expected_fragile & r) : test_counted{r} { if(throws) throw std::runtime_error("copy"); }
+    expected_fragile(expected_fragile && r) : test_counted{r} { if(throws) throw std::runtime_error("move"); }
+    expected_fragile & operator=(const expected_fragile &) = default;
+};
+bool expected_fragile::throws = false;
+
+TEST_CASE("expected is unchanged when replacing an alternative throws")
+{
+    {
+        std::expected<expected_fragile, int> a {std::unexpect, 5};
+        std::expected<expected_fragile, int> b {std::in_place, 3};
+        expected_fragile value {4};
+        REQUIRE(test_counted::live() == 2);
+
+        expected_fragile::throws = true;
+        CHECK_THROWS_AS(a.emplace(1), const std::runtime_error &);
+        CHECK_THROWS_AS(a = b, const std::runtime_error &);
+        CHECK_THROWS_AS(a = std::move(b), const std::runtime_error &);
+        CHECK_THROWS_AS(a = std::move(value), const std::runtime_error &);
+        CHECK_THROWS_AS(b.emplace(2), const std::runtime_error &);
+        expected_fragile::throws = false;
+
+        CHECK(!a);
+        CHECK(a.error() == 5);
+        CHECK(b->value == 3);
+        CHECK(test_counted::live() == 2);
+
+        a = b;
+        CHECK(a->value == 3);
+        a.emplace(6);
+        CHECK(a->value == 6);
+        b = std::make_unexpected(8);
+        CHECK(b.error() == 8);
+        CHECK(test_counted::live() == 2);
+    }
+    CHECK(test_counted::live() == 0);
+}
+
+TEST_CASE("expected monadic operations")
+{
+    auto half = [](int x) -> std::expected<int, parse_error> { if(x % 2) return std::make_unexpected(parse_error::not_a_number); return x / 2; };
+    CHECK(parse_digits("84").and_then(half).and_then(half) == 21);
+    CHECK(parse_digits("42").and_then(half).and_then(half).error() == parse_error::not_a_number);
+    CHECK(parse_digits("").and_then(half).error() == parse_error::empty);
+
+    CHECK(parse_digits("12").transform([](int x) { return std::to_string(x * 2); }) == std::string{"24"});
+    CHECK(parse_digits("1 2").transform_error([](parse_error) { return std::string{"invalid"}; }).error() == "invalid");
+    CHECK(parse_digits("").or_else([](parse_error) -> std::expected<int, parse_error> { return 0; }) == 0);
+    CHECK(parse_digits("5").or_else([](parse_error) -> std::expected<int, parse_error> { return 0; }) == 5);
+
+    // Rvalue chains move the contained value rather than copying it
+    std::expected<std::vector<int>, int> v {std::in_place, 1000, 7};
+    const int * data = v->data();
+    auto w = std::move(v).transform([](std::vector<int> && x) { return std::move(x); });
+    CHECK(w->data() == data);
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include <lazy>
+#include "doctest.h"
+#include "test-payload.h"
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int lazy_global_calls = 0;
+static std::string lazy_global_init() { ++lazy_global_calls; return "table"; }
+static vocab::lazy<std::string> lazy_global {&lazy_global_init};
+
+TEST_CASE("lazy constructs its value on first access")
+{
+    CHECK(lazy_global_calls == 0);
+    CHECK(!lazy_global.has_value());
+    CHECK(*lazy_global == "table");
+    CHECK(lazy_global->size() == 5);
+    CHECK(lazy_global.has_value());
+    CHECK(lazy_global_calls == 1);
+    CHECK(&lazy_global.get() == &*lazy_global);
+    CHECK(lazy_global_calls == 1);
+
+    vocab::lazy<std::vector<int>> v;
+    CHECK(!v.has_value());
+    CHECK(v->empty());
+    v->push_back(3);
+    const auto & c = v;
+    CHECK(c->size() == 1);
+    CHECK((*c)[0] == 3);
+
+    int calls = 0;
+    auto init = [&calls] { ++calls; return test_counted{calls * 10}; };
+    {
+        vocab::lazy<test_counted, decltype(init)> x {init};
+        CHECK(test_counted::live() == 0);
+        CHECK(x->value == 10);
+        CHECK(x->value == 10);
+        CHECK(calls == 1);
+        CHECK(test_counted::live() == 1);
+    }
+    CHECK(test_counted::live() == 0);
+
+    {
+        vocab::lazy<test_counted, decltype(init)> never {init};
+        CHECK(!never.has_value());
+    }
+    CHECK(calls == 1);
+    CHECK(test_counted::live() == 0);
+}
+
+TEST_CASE("lazy retries an initializer which throws")
+{
+    int calls = 0;
+    auto init = [&calls] { if(++calls == 1) throw std::runtime_error("unavailable"); return std::string("ready"); };
+    vocab::lazy<std::string, decltype(init)> x {init};
+    CHECK_THROWS_AS(x.get(), const std::runtime_error &);
+    CHECK(!x.has_value());
+    CHECK(x.get() == "ready");
+    CHECK(calls == 2);
+}
+
+TEST_CASE("lazy constructs its value once when first accessed by many threads")
+{
+    std::atomic<int> calls {0};
+    std::atomic<bool> go {false};
+    auto init = [&calls]
+    {
+        ++calls;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return std::string(1000, 'x');
+    };
+    vocab::lazy<std::string, decltype(init)> x {init};
+
+    const std::string * seen[8] {};
+    std::vector<std::thread> threads;
+    for(auto & s : seen) threads.emplace_back([&]
+    {
+        while(!go.load()) std::this_thread::yield();
+        s = &x.get();
+    });
+    go = true;
+    for(auto & t : threads) t.join();
+
+    CHECK(calls == 1);
+    CHECK(x->size() == 1000);
+    for(auto s : seen) CHECK(s == &*x);
+}
\ No newline at end of file
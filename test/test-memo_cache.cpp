@@ -0,0 +1,63 @@
+#include <memo_cache>
+#include "doctest.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+typedef std::variant<int, std::string> memo_key;
+
+TEST_CASE("memo_cache finds variant keys by alternative")
+{
+    vocab::memo_cache<memo_key, double> cache {64};
+    cache.insert_or_assign(memo_key{std::string{"pi"}}, 3.14);
+    cache.insert_or_assign(7, 49.0);
+
+    REQUIRE(cache.find(std::string{"pi"}));
+    CHECK(*cache.find(std::string{"pi"}) == 3.14);
+    REQUIRE(cache.find(memo_key{7}));
+    CHECK(*cache.find(memo_key{7}) == 49.0);
+    CHECK(!cache.find(8));
+    CHECK(!cache.find(std::string{"e"}));
+    CHECK(cache.size() == 2);
+}
+
+TEST_CASE("memo_cache evicts with a CLOCK policy")
+{
+    vocab::memo_cache<memo_key, int> cache {4, 1};
+    for(int i=0; i<4; ++i) cache.insert_or_assign(i, i * 10);
+    CHECK(cache.find(0));
+    cache.insert_or_assign(4, 40);
+    CHECK(cache.size() == 4);
+    CHECK(cache.find(0));
+    CHECK(!cache.find(1));
+    CHECK(cache.find(4));
+}
+
+TEST_CASE("memo_cache computes each key once across threads")
+{
+    vocab::memo_cache<memo_key, int> cache {64};
+    std::atomic<int> calls {0};
+    std::vector<std::thread> threads;
+    std::atomic<int> total {0};
+    for(int i=0; i<8; ++i) threads.emplace_back([&]()
+    {
+        total += cache.get_or_compute(std::string{"answer"}, [&]()
+        {
+            ++calls;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return 42;
+        });
+    });
+    for(auto & t : threads) t.join();
+    CHECK(calls == 1);
+    CHECK(total == 8 * 42);
+    CHECK(cache.get_or_compute(memo_key{std::string{"answer"}}, []() { return 0; }) == 42);
+}
+
+TEST_CASE("memo_cache does not cache exceptions")
+{
+    vocab::memo_cache<memo_key, int> cache {64};
+    CHECK_THROWS_AS(cache.get_or_compute(1, []() -> int { throw std::runtime_error("failed"); }), const std::runtime_error &);
+    CHECK(!cache.find(1));
+    CHECK(cache.get_or_compute(1, []() { return 5; }) == 5);
+}
\ No newline at end of file
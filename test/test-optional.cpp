@@ -1,10 +1,14 @@
 #include <optional>
 #include "doctest.h"
+#include "test-payload.h"
 #include <string>
+#include <string_view>
+#include <memory>
 #include <map>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 TEST_CASE("construct null std::optional<T>")
 {
@@ -54,4 +58,240 @@ TEST_CASE("optional can be used as key type in unordered containers")
     std::unordered_set<std::optional<std::string>> b {std::string{"Hello"}, std::nullopt, std::string{"world!"}};
     std::unordered_multimap<std::optional<bool>, float> c {{true, 1.1f}, {false, 2.3f}, {std::nullopt, 3.5f}, {false, 4.8f}};
     std::unordered_multiset<std::optional<float>> d {1.1f, 2.3f, std::nullopt, 2.3f, std::nullopt, 4.8f};
+}
+
+TEST_CASE("optional emplace_from constructs from a factory result in place")
+{
+    test_big_payload::copies_and_moves() = 0;
+    std::optional<test_big_payload> a {std::in_place_from, []() { return test_big_payload{'a'}; }};
+    REQUIRE(a.has_value());
+    CHECK(a->bytes[100] == 'a');
+
+    std::optional<test_big_payload> b;
+    auto & p = b.emplace_from([]() { return test_big_payload{'b'}; });
+    REQUIRE(b.has_value());
+    CHECK(&p == &*b);
+    CHECK(p.bytes[4095] == 'b');
+    CHECK(test_big_payload::copies_and_moves() == 0);
+}
+
+TEST_CASE("optional stores its value beside a bool, without a variant index")
+{
+    CHECK(sizeof(std::optional<int>) == 8);
+    CHECK(sizeof(std::optional<char>) == 2);
+    CHECK(sizeof(std::optional<double>) == 16);
+    CHECK(std::is_trivially_copyable<std::optional<int>>::value);
+    CHECK(std::is_trivially_destructible<std::optional<int>>::value);
+    CHECK(!std::is_trivially_copyable<std::optional<std::string>>::value);
+
+    constexpr std::optional<int> a {42}, b;
+    static_assert(a.has_value() && *a == 42 && !b.has_value(), "optional of a literal type is usable in constant expressions");
+}
+
+TEST_CASE("optional moves without throwing when its value does")
+{
+    CHECK(std::is_nothrow_move_constructible<std::optional<std::string>>::value);
+    CHECK(std::is_nothrow_move_assignable<std::optional<std::string>>::value);
+    struct throwing_move { throwing_move() {} throwing_move(throwing_move &&) {} };
+    CHECK(!std::is_nothrow_move_constructible<std::optional<throwing_move>>::value);
+
+    // So a vector moves its elements when it reallocates, rather than copying them
+    std::vector<std::optional<std::string>> v;
+    v.push_back(std::string{"a string much too long for the small string buffer"});
+    const char * data = v[0]->data();
+    for(int i=0; i<16; ++i) v.push_back(std::nullopt);
+    CHECK(v[0]->data() == data);
+}
+
+TEST_CASE("optional constructs and destroys its value exactly once")
+{
+    test_counted::live() = 0;
+    {
+        std::optional<test_counted> a {test_counted{1}}, b;
+        CHECK(test_counted::live() == 1);
+        b = a;
+        CHECK(test_counted::live() == 2);
+        b = std::nullopt;
+        CHECK(test_counted::live() == 1);
+        b.swap(a);
+        CHECK(!a);
+        CHECK(b->value == 1);
+        CHECK(test_counted::live() == 1);
+        a.emplace(2);
+        a.swap(b);
+        CHECK(a->value == 1);
+        CHECK(b->value == 2);
+        CHECK(test_counted::live() == 2);
+        std::optional<test_counted> c {std::move(a)};
+        CHECK(c->value == 1);
+        CHECK(test_counted::live() == 3);
+        c.reset();
+        c.reset();
+        CHECK(test_counted::live() == 2);
+        CHECK_THROWS_AS(c.value(), const std::bad_optional_access &);
+    }
+    CHECK(test_counted::live() == 0);
+}
+
+// Counts the allocations made through it, so that a test can check that strings are not copied
+static size_t optional_allocations = 0;
+template<class T> struct optional_counting_allocator
+{
+    typedef T value_type;
+    optional_counting_allocator() = default;
+    template<class U> optional_counting_allocator(const optional_counting_allocator<U> &) noexcept {}
+    T * allocate(size_t n) { ++optional_allocations; return std::allocator<T>{}.allocate(n); }
+    void deallocate(T * p, size_t n) noexcept { std::allocator<T>{}.deallocate(p, n); }
+    template<class U> bool operator == (const optional_counting_allocator<U> &) const noexcept { return true; }
+    template<class U> bool operator != (const optional_counting_allocator<U> &) const noexcept { return false; }
+};
+typedef std::basic_string<char, std::char_traits<char>, optional_counting_allocator<char>> test_counted_string;
+
+TEST_CASE("optional compares with nullopt and values without allocating")
+{
+    const std::optional<test_counted_string> a {test_counted_string{"a string much too long for the small string buffer"}}, b;
+    const test_counted_string s {"a string much too long for the small string buffer"};
+    const std::string_view sv {s};
+    const char * p = "a string much too long for the small string buffer";
+
+    const size_t allocations = optional_allocations;
+    const bool results[] = {
+        a == s, s == a, a == sv, sv == a, a == p, !(a != p), b != s, b < sv, sv > b,
+        a <= sv, a >= sv, !(a < sv), a > b, a != std::nullopt, b == std::nullopt,
+        std::nullopt < a, std::nullopt <= b, !(a < std::nullopt)
+    };
+    CHECK(optional_allocations == allocations);
+    for(bool r : results) CHECK(r);
+}
+
+TEST_CASE("optional compares with values of other types")
+{
+    const std::optional<int> a {3}, b;
+    CHECK(a == 3L);
+    CHECK(a < 3.5);
+    CHECK(2.5 < a);
+    CHECK(b < 0.0);
+    CHECK(!(b > 0.0));
+    CHECK(b != 0L);
+    CHECK(std::optional<long>{3} == 3);
+}
+
+struct optional_config { std::string name; int threads; };
+
+TEST_CASE("optional<T &> refers to a value without copying it, and rebinds on assignment")
+{
+    CHECK(sizeof(std::optional<optional_config &>) == sizeof(optional_config *));
+    CHECK(std::is_trivially_copyable<std::optional<optional_config &>>::value);
+    CHECK((!std::is_constructible<std::optional<const int &>, int>::value));
+
+    std::map<std::string, optional_config> configs {{"a", {"alpha", 4}}, {"b", {"beta", 8}}};
+    auto find_config = [&](const std::string & key) -> std::optional<optional_config &> { auto it = configs.find(key); if(it == configs.end()) return std::nullopt; return it->second; };
+
+    auto a = find_config("a"), c = find_config("c");
+    REQUIRE(a);
+    CHECK(!c);
+    CHECK(&*a == &configs["a"]);
+    CHECK(a->threads == 4);
+    CHECK_THROWS_AS(c.value(), const std::bad_optional_access &);
+
+    a->threads = 5;
+    CHECK(configs["a"].threads == 5);
+
+    optional_config & b = configs["b"];
+    a = b;
+    CHECK(&*a == &b);
+    CHECK(configs["a"].threads == 5);
+    CHECK(configs["a"].name == "alpha");
+
+    optional_config fallback {"fallback", 1};
+    CHECK(&c.value_or(fallback) == &fallback);
+    CHECK(&a.value_or(fallback) == &b);
+    CHECK(c.value_or(optional_config{"temporary", 2}).name == "temporary");
+
+    std::optional<const optional_config &> ca = a;
+    CHECK(&*ca == &b);
+
+    std::optional<std::string &> name = a.transform([](optional_config & cfg) -> std::string & { return cfg.name; });
+    REQUIRE(name);
+    CHECK(&*name == &b.name);
+    std::optional<int> threads = a.transform([](const optional_config & cfg) { return cfg.threads; });
+    CHECK(threads == 8);
+    CHECK(!c.transform([](optional_config & cfg) -> std::string & { return cfg.name; }));
+    optional_config spare {"spare", 1};
+    auto taken = std::optional<optional_config &>{spare}.transform([](optional_config & cfg) -> std::string && { return std::move(cfg.name); });
+    CHECK((std::is_same<decltype(taken), std::optional<std::string>>::value));
+    CHECK(taken == "spare");
+
+    CHECK(&*a.and_then([&](optional_config &) { return find_config("a"); }) == &configs["a"]);
+    CHECK(!c.and_then([&](optional_config &) { return find_config("a"); }));
+    CHECK(&*c.or_else([&]() { return find_config("b"); }) == &b);
+
+    CHECK(name == b.name);
+    CHECK(name != std::optional<std::string &>{});
+    CHECK(c == std::nullopt);
+    CHECK(std::optional<int &>{threads.value()} == 8);
+    CHECK(std::hash<std::optional<std::string &>>{}(name) == std::hash<std::string>{}(b.name));
+
+    c = a;
+    a.reset();
+    CHECK(!a);
+    CHECK(&*c == &b);
+}
+
+struct optional_expensive_default
+{
+    static int constructions;
+    std::string text;
+    optional_expensive_default(std::string t) : text{std::move(t)} { ++constructions; }
+};
+int optional_expensive_default::constructions = 0;
+
+TEST_CASE("optional value_or_else and the monadic operations are lazy")
+{
+    optional_expensive_default::constructions = 0;
+    std::optional<optional_expensive_default> a {std::in_place, "present"}, b;
+    CHECK(optional_expensive_default::constructions == 1);
+
+    // No default is built while a value is present
+    int present = 0;
+    for(int i=0; i<1000; ++i) present += a.value_or_else([]() { return optional_expensive_default{"default"}; }).text == "present";
+    CHECK(present == 1000);
+    CHECK(optional_expensive_default::constructions == 1);
+    CHECK(b.value_or_else([]() { return optional_expensive_default{"default"}; }).text == "default");
+    CHECK(optional_expensive_default::constructions == 2);
+
+    int calls = 0;
+    auto f = [&](const optional_expensive_default & x) { ++calls; return std::optional<size_t>{x.text.size()}; };
+    CHECK(a.and_then(f) == 7u);
+    CHECK(!b.and_then(f));
+    CHECK(calls == 1);
+    CHECK(a.transform([&](const optional_expensive_default & x) { ++calls; return x.text.size(); }) == 7u);
+    CHECK(!b.transform([&](const optional_expensive_default & x) { ++calls; return x.text.size(); }));
+    CHECK(calls == 2);
+    CHECK(a.or_else([&]() { ++calls; return std::optional<optional_expensive_default>{}; })->text == "present");
+    CHECK(b.or_else([&]() { ++calls; return std::optional<optional_expensive_default>{std::in_place, "else"}; })->text == "else");
+    CHECK(calls == 3);
+}
+
+TEST_CASE("optional monadic operations move from rvalues and construct results in place")
+{
+    std::optional<std::string> a {std::string(100, 'x')};
+    const char * data = a->data();
+    std::string s = std::move(a).value_or("default");
+    CHECK(s.data() == data);
+
+    std::optional<std::string> b {std::string(100, 'y')};
+    data = b->data();
+    std::optional<std::string> c = std::move(b).transform([](std::string && x) { return std::move(x); });
+    CHECK(c->data() == data);
+    data = c->data();
+    std::optional<std::string> d = std::move(c).and_then([](std::string && x) { return std::optional<std::string>{std::move(x)}; });
+    CHECK(d->data() == data);
+    CHECK(std::move(d).value_or_else([]() { return std::string{}; }).data() == data);
+
+    test_big_payload::copies_and_moves() = 0;
+    std::optional<int> e {3};
+    std::optional<test_big_payload> g = e.transform([](int x) { return test_big_payload{char('0' + x)}; });
+    CHECK(g->bytes[0] == '3');
+    CHECK(test_big_payload::copies_and_moves() == 0);
 }
\ No newline at end of file
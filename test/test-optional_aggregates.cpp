@@ -0,0 +1,126 @@
+#include <optional_aggregates>
+#include "doctest.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// The engaged elements of a column, summarized one at a time with a branch on each, as the kernels are checked against
+template<class T> vocab::engaged_summary<T> aggregates_naive(const std::vector<std::optional<T>> & elements)
+{
+    vocab::engaged_summary<T> r {0, T(0), std::nullopt, std::nullopt};
+    for(auto & e : elements)
+    {
+        if(!e) continue;
+        ++r.count;
+        r.sum += *e;
+        if(!r.min || *e < *r.min) r.min = *e;
+        if(!r.max || *r.max < *e) r.max = *e;
+    }
+    return r;
+}
+
+// A column of whole numbers, so that sums are exact in any order, of which roughly one element in engaged_every is engaged
+template<class T> std::vector<std::optional<T>> aggregates_column(size_t n, uint32_t engaged_every)
+{
+    std::vector<std::optional<T>> elements(n);
+    uint32_t state = 12345;
+    for(auto & e : elements)
+    {
+        state = state * 1664525 + 1013904223;
+        if((state >> 8) % engaged_every == 0) e = static_cast<T>(static_cast<int>(state >> 16) % 2001 - 1000);
+    }
+    return elements;
+}
+
+template<class T> void aggregates_check(const std::vector<std::optional<T>> & elements)
+{
+    const auto expected = aggregates_naive(elements);
+    vocab::optional_array<T> array;
+    for(auto & e : elements) array.push_back(e);
+
+    const vocab::engaged_summary<T> actual[] = {vocab::summarize_engaged(elements), vocab::summarize_engaged(array)};
+    for(auto & a : actual)
+    {
+        CHECK(a.count == expected.count);
+        CHECK(a.sum == expected.sum);
+        CHECK(a.min == expected.min);
+        CHECK(a.max == expected.max);
+        CHECK(a.mean() == expected.mean());
+    }
+}
+
+TEST_CASE("summarize_engaged agrees with a branching loop")
+{
+    for(size_t n : {0, 1, 3, 4, 7, 64, 65, 130, 1001})
+    {
+        for(uint32_t every : {1, 2, 10, 100})
+        {
+            aggregates_check(aggregates_column<double>(n, every));
+            aggregates_check(aggregates_column<int64_t>(n, every));
+            aggregates_check(aggregates_column<float>(n, every));
+            aggregates_check(aggregates_column<int>(n, every));
+        }
+    }
+}
+
+TEST_CASE("summarize_engaged ignores the values of empty elements")
+{
+    std::vector<std::optional<double>> elements {std::nullopt, 2.0, std::nullopt, -1.0, 4.0, std::nullopt, std::nullopt, 0.5};
+    auto s = vocab::summarize_engaged(elements);
+    CHECK(s.count == 4);
+    CHECK(s.sum == 5.5);
+    CHECK(s.min == -1.0);
+    CHECK(s.max == 4.0);
+    CHECK(s.mean() == 5.5 / 4);
+
+    // The value slots of reset elements of an optional_array still hold their old values
+    vocab::optional_array<double> array(8);
+    for(size_t i=0; i<8; ++i) array[i] = i % 2 ? NAN : 1000.0;
+    for(size_t i=0; i<8; ++i) array[i] = elements[i];
+    s = vocab::summarize_engaged(array);
+    CHECK(s.count == 4);
+    CHECK(s.sum == 5.5);
+    CHECK(s.min == -1.0);
+    CHECK(s.max == 4.0);
+
+    const std::vector<std::optional<int64_t>> empty(9);
+    const auto e = vocab::summarize_engaged(empty);
+    CHECK(e.count == 0);
+    CHECK(e.sum == 0);
+    CHECK(!e.min);
+    CHECK(!e.max);
+    CHECK(!e.mean());
+
+    const std::vector<std::optional<int64_t>> extremes {INT64_MAX, std::nullopt, INT64_MIN, std::nullopt, 0};
+    const auto x = vocab::summarize_engaged(extremes);
+    CHECK(x.min == INT64_MIN);
+    CHECK(x.max == INT64_MAX);
+}
+
+#ifdef __AVX2__
+TEST_CASE("summarize_engaged's AVX2 kernels read std::optional's layout")
+{
+    // The kernels assume that an optional holds its value in its first eight bytes, and its flag in the low byte of
+    // the next eight
+    std::optional<double> engaged {2.5}, empty;
+    double value; unsigned char flag_engaged, flag_empty;
+    std::memcpy(&value, &engaged, sizeof(value));
+    std::memcpy(&flag_engaged, reinterpret_cast<const unsigned char *>(&engaged) + 8, 1);
+    std::memcpy(&flag_empty, reinterpret_cast<const unsigned char *>(&empty) + 8, 1);
+    CHECK(value == 2.5);
+    CHECK(flag_engaged != 0);
+    CHECK(flag_empty == 0);
+
+    // Both kernels consume whole groups of four elements, and leave the rest to the scalar loop
+    const auto elements = aggregates_column<double>(7, 2);
+    vocab::detail::summary_kernel<double> kernel;
+    CHECK(kernel.add_optionals(elements.data(), elements.size()) == 4);
+    const int64_t values[8] {1, 2, 3, 4, 5, 6, 7, 8};
+    vocab::detail::summary_kernel<int64_t> masked;
+    CHECK(masked.add_masked(values, 0xA5, 7) == 4);
+    const auto r = masked.result();
+    CHECK(r.count == 2);
+    CHECK(r.sum == 4);
+}
+#endif
\ No newline at end of file
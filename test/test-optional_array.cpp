@@ -0,0 +1,80 @@
+#include <optional_array>
+#include "doctest.h"
+#include <string>
+#include <vector>
+
+TEST_CASE("optional_array holds the same elements as a vector of optionals")
+{
+    vocab::optional_array<int> a {1, std::nullopt, 3};
+    REQUIRE(a.size() == 3);
+    CHECK(a.has_value(0));
+    CHECK(!a.has_value(1));
+    CHECK(a[0].value() == 1);
+    CHECK(!a[1]);
+    CHECK_THROWS_AS(a[1].value(), const std::bad_optional_access &);
+    CHECK(a[1].value_or(7) == 7);
+    CHECK(a[2].value_or(7) == 3);
+    CHECK(a.count() == 2);
+
+    a.push_back(4);
+    a.push_back(std::nullopt);
+    a.push_back(std::optional<int>{6});
+    a.emplace_back(7);
+    CHECK(a.size() == 7);
+    CHECK(a.count() == 5);
+
+    a[1] = 2;
+    a[0] = std::nullopt;
+    a[3].reset();
+    a[4] = a[2];
+    a[5] = a[3];
+    CHECK(!a[0]);
+    CHECK(*a[1] == 2);
+    CHECK(!a[3]);
+    CHECK(*a[4] == 3);
+    CHECK(!a[5]);
+    CHECK(a.count() == 4);
+
+    const std::optional<int> copy = a[4];
+    CHECK(copy == 3);
+    const std::optional<int &> ref = a[4];
+    CHECK(&*ref == a.values() + 4);
+    *ref = 40;
+    CHECK(*a[4] == 40);
+
+    const auto & ca = a;
+    CHECK(ca[4] == 40);
+    CHECK(ca[0] == std::nullopt);
+
+    a.pop_back();
+    CHECK(a.size() == 6);
+    CHECK(a.count() == 3);
+}
+
+TEST_CASE("optional_array scans its validity bitmap a word at a time")
+{
+    vocab::optional_array<std::string> a(1000);
+    CHECK(a.size() == 1000);
+    CHECK(a.count() == 0);
+    CHECK(a.bitmap_words() == 16);
+
+    std::vector<size_t> expected;
+    for(size_t i=0; i<990; i+=37) { a[i] = std::to_string(i); expected.push_back(i); }
+    a[999] = "last";
+    expected.push_back(999);
+    CHECK(a.count() == expected.size());
+
+    std::vector<size_t> visited;
+    a.for_each_engaged([&](size_t i, std::string & s) { visited.push_back(i); if(i != 999) CHECK(s == std::to_string(i)); });
+    CHECK(visited == expected);
+
+    // Shrinking clears the bits past the new size, so that growing again yields empty elements
+    a.resize(500);
+    a.resize(1000);
+    CHECK(!a[999]);
+    CHECK(a.count() == (500 + 36) / 37);
+    size_t n = 0;
+    const auto & ca = a;
+    ca.for_each_engaged([&](size_t i, const std::string &) { CHECK(i < 500); ++n; });
+    CHECK(n == a.count());
+}
\ No newline at end of file
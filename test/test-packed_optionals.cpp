@@ -0,0 +1,113 @@
+#include <packed_optionals>
+#include "doctest.h"
+#include <cstdint>
+#include <cstring>
+
+typedef vocab::packed_optionals<int32_t, float, int32_t, double> packed_message;
+
+struct packed_thirty_fields
+{
+    std::optional<int32_t> a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14;
+    std::optional<float> b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14;
+};
+typedef vocab::packed_optionals<int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t,
+    int32_t, int32_t, int32_t, int32_t, int32_t, float, float, float, float, float, float, float, float, float, float,
+    float, float, float, float, float> packed_thirty;
+
+TEST_CASE("packed_optionals keeps one presence word and packs its payloads")
+{
+    CHECK(sizeof(vocab::packed_optionals<int32_t>) == 8);
+    CHECK(sizeof(vocab::packed_optionals<uint8_t, uint8_t, uint8_t>) == 4);
+    CHECK(sizeof(packed_thirty) == 124);
+    CHECK(sizeof(packed_thirty_fields) == 240);
+    CHECK(std::is_trivially_copyable<packed_thirty>::value);
+
+    CHECK((std::is_same<vocab::packed_optionals<int, int, int, int, int, int, int, int>::presence_type, uint8_t>::value));
+    CHECK((std::is_same<vocab::packed_optionals<int, int, int, int, int, int, int, int, int>::presence_type, uint16_t>::value));
+    CHECK((std::is_same<packed_thirty::presence_type, uint32_t>::value));
+
+    CHECK(packed_message::offset<0>::value == 0);
+    CHECK(packed_message::offset<1>::value == 4);
+    CHECK(packed_message::offset<2>::value == 8);
+    CHECK(packed_message::offset<3>::value == 16);
+    CHECK(sizeof(packed_message) == 32);
+}
+
+TEST_CASE("packed_optionals fields behave like optionals")
+{
+    packed_message m;
+    CHECK(m.count() == 0);
+    CHECK(m.presence() == 0);
+    CHECK(!m.get<0>());
+    CHECK(m.get<1>().value_or(2.5f) == 2.5f);
+    CHECK_THROWS_AS(m.get<2>().value(), const std::bad_optional_access &);
+
+    m.get<0>() = 7;
+    m.get<3>() = 1.5;
+    CHECK(m.has_value<0>());
+    CHECK(!m.has_value<1>());
+    CHECK(*m.get<0>() == 7);
+    CHECK(m.get<3>().value() == 1.5);
+    CHECK(m.presence() == 9);
+    CHECK(m.count() == 2);
+
+    *m.get<0>() += 1;
+    CHECK(vocab::get<0>(m).value() == 8);
+
+    std::optional<int32_t> a = m.get<0>();
+    std::optional<float> b = m.get<1>();
+    CHECK(a == 8);
+    CHECK(!b);
+
+    std::optional<int32_t &> r = m.get<0>();
+    *r = 9;
+    CHECK(*m.get<0>() == 9);
+
+    const packed_message & c = m;
+    CHECK(c.get<0>() == 9);
+    CHECK(!c.get<1>());
+    CHECK(vocab::get<3>(c) == 1.5);
+
+    m.get<2>() = m.get<0>();
+    m.get<0>() = std::nullopt;
+    m.get<3>().reset();
+    CHECK(!m.has_value<0>());
+    CHECK(m.get<2>().value() == 9);
+    CHECK(m.count() == 1);
+
+    m.get<1>() = std::optional<float>{0.5f};
+    CHECK(m.count() == 2);
+    m.reset();
+    CHECK(m.count() == 0);
+}
+
+TEST_CASE("packed_optionals compares by value and copies by representation")
+{
+    packed_message a {1, std::nullopt, 3, std::nullopt};
+    CHECK(a.count() == 2);
+    CHECK(a.get<2>().value() == 3);
+
+    packed_message b;
+    b.get<0>() = 1;
+    b.get<1>() = 2.0f;
+    b.get<2>() = 3;
+    CHECK(a != b);
+    b.get<1>() = std::nullopt;
+    CHECK(a == b);
+
+    // Absent fields hold zero bytes, so records holding identical values serialize to identical bytes
+    unsigned char bytes_a[sizeof(packed_message)], bytes_b[sizeof(packed_message)];
+    std::memcpy(bytes_a, &a, sizeof(a));
+    std::memcpy(bytes_b, &b, sizeof(b));
+    CHECK(std::memcmp(bytes_a, bytes_b, sizeof(packed_message)) == 0);
+
+    packed_message c;
+    std::memcpy(&c, bytes_a, sizeof(c));
+    CHECK(c == a);
+    CHECK(c.get<0>().value() == 1);
+
+    // Present fields compare by value, whatever their bytes
+    packed_message z {std::nullopt, std::nullopt, std::nullopt, 0.0}, nz {std::nullopt, std::nullopt, std::nullopt, -0.0};
+    CHECK(z == nz);
+    CHECK(std::memcmp(&z, &nz, sizeof(packed_message)) != 0);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include <parallel_visit>
+#include "doctest.h"
+#include <string>
+
+TEST_CASE("parallel_visit visits every element exactly once")
+{
+    std::vector<std::variant<int, double>> events;
+    for(int i=0; i<10000; ++i) events.push_back(i % 3 ? std::variant<int, double>{i} : std::variant<int, double>{i * 1.0});
+
+    std::vector<std::atomic<int>> visits(events.size());
+    for(auto & v : visits) v = 0;
+    vocab::work_stealing_pool pool {3};
+    CHECK(pool.size() == 3);
+    vocab::parallel_visit(pool, events.begin(), events.end(), [&](const auto & x) { ++visits[static_cast<size_t>(x)]; }, 64);
+    CHECK(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int> & v) { return v == 1; }));
+}
+
+TEST_CASE("parallel_visit_reduce is deterministic")
+{
+    std::vector<std::variant<int, double, std::string>> events;
+    for(int i=0; i<100000; ++i)
+    {
+        if(i % 10 == 0) events.push_back(std::string{"x"});
+        else if(i % 2) events.push_back(i);
+        else events.push_back(1.0 / i);
+    }
+
+    struct totals { long long ints = 0; double doubles = 0; size_t strings = 0; };
+    struct accumulate
+    {
+        void operator() (totals & t, int x) const { t.ints += x; }
+        void operator() (totals & t, double x) const { t.doubles += x; }
+        void operator() (totals & t, const std::string & s) const { t.strings += s.size(); }
+    };
+    auto combine = [](totals a, const totals & b) { a.ints += b.ints; a.doubles += b.doubles; a.strings += b.strings; return a; };
+
+    vocab::work_stealing_pool one {0}, four {4};
+    const totals a = vocab::parallel_visit_reduce(one, events.begin(), events.end(), totals{}, accumulate{}, combine, 256);
+    const totals b = vocab::parallel_visit_reduce(four, events.begin(), events.end(), totals{}, accumulate{}, combine, 256);
+    const totals c = vocab::parallel_visit_reduce(events.begin(), events.end(), totals{}, accumulate{}, combine, 256);
+    CHECK(a.ints == 2500000000LL);
+    CHECK(a.strings == 10000);
+    CHECK(a.ints == b.ints);
+    CHECK(a.doubles == b.doubles);
+    CHECK(a.doubles == c.doubles);
+}
+
+TEST_CASE("parallel_visit treats a grain of zero as one")
+{
+    std::vector<std::variant<int, double>> events {1, 2.0, 3, 4.0, 5};
+    vocab::work_stealing_pool pool {2};
+    std::atomic<int> count {0};
+    vocab::parallel_visit(pool, events.begin(), events.end(), [&](auto) { ++count; }, 0);
+    CHECK(count == 5);
+
+    const double total = vocab::parallel_visit_reduce(pool, events.begin(), events.end(), 0.0, [](double & t, auto x) { t += x; }, std::plus<double>{}, 0);
+    CHECK(total == 15.0);
+}
+
+TEST_CASE("parallel_visit rethrows exceptions from the visitor")
+{
+    std::vector<std::variant<int, double>> events(1000, 1);
+    events[777] = 2.0;
+    vocab::work_stealing_pool pool {2};
+    CHECK_THROWS_AS(vocab::parallel_visit(pool, events.begin(), events.end(), [](auto x) { if(x == 2.0) throw std::runtime_error("bad event"); }, 16), const std::runtime_error &);
+
+    int count = 0;
+    vocab::parallel_visit(events.begin(), events.begin(), [&](auto) { ++count; });
+    CHECK(count == 0);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef VOCAB_TYPES_TEST_PAYLOAD
+#define VOCAB_TYPES_TEST_PAYLOAD
+
+#include <algorithm>
+#include <atomic>
+
+// A value too large to be copied or moved unnoticed, which counts how many times it has been, for tests that a value
+// is constructed in place
+struct test_big_payload
+{
+    static int & copies_and_moves() { static int count = 0; return count; }
+    char bytes[4096];
+    test_big_payload(char c) { std::fill(bytes, bytes + sizeof(bytes), c); }
+    test_big_payload(const test_big_payload & r) { std::copy(r.bytes, r.bytes + sizeof(bytes), bytes); ++copies_and_moves(); }
+};
+
+// A value which counts how many instances of it are alive, for tests that a value is constructed and destroyed exactly
+// once. The count is shared by every test, each of which should leave it at zero.
+struct test_counted
+{
+    static std::atomic<int> & live() { static std::atomic<int> count {0}; return count; }
+    int value;
+    test_counted(int value) noexcept : value{value} { ++live(); }
+    test_counted(const test_counted & r) noexcept : value{r.value} { ++live(); }
+    test_counted & operator=(const test_counted &) = default;
+    ~test_counted() { --live(); }
+};
+
+#endif
\ No newline at end of file
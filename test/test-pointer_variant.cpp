@@ -0,0 +1,65 @@
+#include <pointer_variant>
+#include "doctest.h"
+#include <atomic>
+#include <string>
+#include <type_traits>
+
+struct pv_node { int id; };
+struct pv_leaf { double weight; };
+typedef vocab::pointer_variant<pv_node *, pv_leaf *, std::string *> pv_edge;
+
+TEST_CASE("pointer_variant is one trivially copyable word")
+{
+    CHECK(sizeof(pv_edge) == sizeof(void *));
+    CHECK(std::is_trivially_copyable<pv_edge>::value);
+    CHECK(pv_edge::tag_bits == 2);
+    CHECK(std::variant_size<pv_edge>::value == 3);
+    CHECK((std::is_same<std::variant_alternative_t<1, pv_edge>, pv_leaf *>::value));
+
+    pv_edge e;
+    CHECK(e.index() == 0);
+    CHECK(!e);
+    CHECK(vocab::get<pv_node *>(e) == nullptr);
+}
+
+TEST_CASE("pointer_variant get, get_if, holds_alternative and visit")
+{
+    pv_node n {7};
+    pv_leaf l {0.5};
+    std::string s {"label"};
+
+    pv_edge e {&l};
+    CHECK(e.index() == 1);
+    CHECK(vocab::holds_alternative<pv_leaf *>(e));
+    CHECK(!vocab::holds_alternative<pv_node *>(e));
+    CHECK(vocab::get<1>(e) == &l);
+    CHECK(vocab::get_if<pv_leaf *>(&e) == &l);
+    CHECK(vocab::get_if<pv_node *>(&e) == nullptr);
+    CHECK_THROWS_AS(vocab::get<pv_node *>(e), const std::bad_variant_access &);
+
+    struct describe
+    {
+        std::string operator() (pv_node * p) const { return "node " + std::to_string(p->id); }
+        std::string operator() (pv_leaf * p) const { return "leaf " + std::to_string(static_cast<int>(p->weight * 10)); }
+        std::string operator() (std::string * p) const { return "string " + *p; }
+    };
+    CHECK(vocab::visit(describe{}, e) == "leaf 5");
+    e = &n;
+    CHECK(vocab::visit(describe{}, e) == "node 7");
+    e.emplace<2>(&s);
+    CHECK(vocab::visit(describe{}, e) == "string label");
+    CHECK(e.address() == &s);
+    CHECK(e == pv_edge{&s});
+    CHECK(e != pv_edge{&n});
+}
+
+TEST_CASE("pointer_variant can be used with std::atomic")
+{
+    pv_node n {1};
+    pv_leaf l {2};
+    std::atomic<pv_edge> edge {pv_edge{&n}};
+    pv_edge expected {&n};
+    CHECK(edge.compare_exchange_strong(expected, pv_edge{&l}));
+    CHECK(vocab::get<pv_leaf *>(edge.load()) == &l);
+    CHECK(pv_edge::from_raw(edge.load().raw()) == pv_edge{&l});
+}
\ No newline at end of file
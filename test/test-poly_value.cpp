@@ -0,0 +1,81 @@
+#include <poly_value>
+#include "doctest.h"
+#include "test-payload.h"
+#include <string>
+#include <vector>
+
+struct poly_shape
+{
+    test_counted counted {0};
+    virtual ~poly_shape() = default;
+    virtual double area() const = 0;
+};
+
+struct poly_square : poly_shape { double side; poly_square(double side) : side{side} {} double area() const override { return side * side; } };
+struct poly_tag { std::string name; };
+struct poly_label : poly_tag, poly_shape { poly_label(std::string name) : poly_tag{name} {} double area() const override { return static_cast<double>(name.size()); } };
+
+typedef vocab::poly_value<poly_shape, 64> poly_shape_value;
+
+TEST_CASE("poly_value stores derived types inline")
+{
+    {
+        poly_shape_value a;
+        CHECK(!a);
+        CHECK(a.type() == typeid(void));
+
+        a = poly_square{3};
+        REQUIRE(a);
+        CHECK(a.type() == typeid(poly_square));
+        CHECK(a->area() == 9);
+        CHECK(static_cast<const void *>(a.get()) >= static_cast<const void *>(&a));
+        CHECK(static_cast<const void *>(a.get()) < static_cast<const void *>(&a + 1));
+
+        poly_shape_value b {std::in_place<poly_label>, "hello"};
+        CHECK(b->area() == 5);
+        CHECK(static_cast<poly_label &>(*b).name == "hello");
+        CHECK(test_counted::live() == 2);
+    }
+    CHECK(test_counted::live() == 0);
+}
+
+TEST_CASE("poly_value copies and moves through its manager")
+{
+    {
+        poly_shape_value a {poly_label{"four"}};
+        poly_shape_value b {a};
+        CHECK(b->area() == 4);
+        CHECK(b.get() != a.get());
+        CHECK(static_cast<poly_label &>(*b).name == "four");
+
+        poly_shape_value c {std::move(b)};
+        CHECK(!b);
+        CHECK(c->area() == 4);
+        CHECK(static_cast<poly_label &>(*c).name == "four");
+
+        b = c;
+        CHECK(b->area() == 4);
+        c = poly_square{2};
+        a = std::move(c);
+        CHECK(!c);
+        CHECK(a->area() == 4);
+        CHECK(a.type() == typeid(poly_square));
+        CHECK(test_counted::live() == 2);
+        a.reset();
+        CHECK(test_counted::live() == 1);
+    }
+    CHECK(test_counted::live() == 0);
+}
+
+TEST_CASE("poly_value moves without throwing")
+{
+    CHECK(std::is_nothrow_move_constructible<poly_shape_value>::value);
+    CHECK(std::is_nothrow_move_assignable<poly_shape_value>::value);
+
+    // So a vector moves its elements when it reallocates, rather than copying them
+    std::vector<poly_shape_value> shapes;
+    shapes.emplace_back(poly_label{"a label much too long for the small string buffer"});
+    const char * data = static_cast<poly_label &>(*shapes[0]).name.data();
+    for(int i=0; i<16; ++i) shapes.emplace_back(poly_square{1});
+    CHECK(static_cast<poly_label &>(*shapes[0]).name.data() == data);
+}
\ No newline at end of file
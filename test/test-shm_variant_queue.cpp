@@ -0,0 +1,108 @@
+#include <shm_variant_queue>
+#include "doctest.h"
+
+#ifdef __linux__
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+
+struct shm_tick { int sequence; double price; };
+struct shm_halt { int code; };
+
+TEST_CASE("shm_variant_queue exchanges messages between two processes")
+{
+    const std::string name = "/vocab-types-test-" + std::to_string(getpid());
+    vocab::shm_variant_queue<shm_tick, shm_halt>::unlink(name.c_str());
+    vocab::shm_variant_queue<shm_tick, shm_halt> queue {name.c_str(), 16};
+    CHECK(queue.capacity() == 16);
+
+    const pid_t child = fork();
+    REQUIRE(child >= 0);
+    if(child == 0)
+    {
+        // The child attaches to the segment by name, and sends more messages than fit in the ring at once
+        vocab::shm_variant_queue<shm_tick, shm_halt> sender {name.c_str(), 16};
+        for(int i=1; i<=1000; ++i) sender.emplace<shm_tick>(shm_tick{i, i * 0.5});
+        sender.emplace<shm_halt>(shm_halt{7});
+        _exit(0);
+    }
+
+    struct totals
+    {
+        long long sequence_sum = 0; int next = 1, halt = 0; bool in_order = true;
+        void operator() (const shm_tick & t) { in_order &= t.sequence == next++; sequence_sum += t.sequence; }
+        void operator() (const shm_halt & h) { halt = h.code; }
+    } t;
+    while(!t.halt) queue.receive(t);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    vocab::shm_variant_queue<shm_tick, shm_halt>::unlink(name.c_str());
+    CHECK(WIFEXITED(status));
+    CHECK(t.in_order);
+    CHECK(t.sequence_sum == 500500);
+    CHECK(t.halt == 7);
+}
+
+TEST_CASE("shm_variant_queue refuses to attach to an incompatible segment")
+{
+    const std::string name = "/vocab-types-test-layout-" + std::to_string(getpid());
+    vocab::shm_variant_queue<shm_tick, shm_halt>::unlink(name.c_str());
+    vocab::shm_variant_queue<shm_tick, shm_halt> queue {name.c_str(), 8};
+    CHECK(queue.try_emplace<shm_halt>(shm_halt{1}));
+    CHECK_THROWS_AS((vocab::shm_variant_queue<shm_halt, shm_tick>{name.c_str(), 8}), const std::runtime_error &);
+    CHECK_THROWS_AS((vocab::shm_variant_queue<shm_tick, shm_halt>{name.c_str(), 4}), const std::runtime_error &);
+
+    // A process which specifies the wrong capacity leaves the segment's size alone
+    auto segment_size = [&]() { const int fd = shm_open(name.c_str(), O_RDONLY, 0); struct stat st {}; fstat(fd, &st); close(fd); return st.st_size; };
+    const auto size = segment_size();
+    CHECK_THROWS_AS((vocab::shm_variant_queue<shm_tick, shm_halt>{name.c_str(), 64}), const std::runtime_error &);
+    CHECK(segment_size() == size);
+    CHECK(queue.try_emplace<shm_halt>(shm_halt{2}));
+    vocab::shm_variant_queue<shm_tick, shm_halt>::unlink(name.c_str());
+
+    // Alternatives of the same sizes are told apart by their names and order
+    vocab::shm_variant_queue<int, float>::unlink(name.c_str());
+    vocab::shm_variant_queue<int, float> numbers {name.c_str(), 8};
+    CHECK_THROWS_AS((vocab::shm_variant_queue<float, int>{name.c_str(), 8}), const std::runtime_error &);
+    CHECK_THROWS_AS((vocab::shm_variant_queue<int, unsigned>{name.c_str(), 8}), const std::runtime_error &);
+    vocab::shm_variant_queue<int, float> same {name.c_str(), 8};
+    CHECK(same.capacity() == 8);
+    vocab::shm_variant_queue<int, float>::unlink(name.c_str());
+}
+
+struct shm_checked
+{
+    int value;
+    explicit shm_checked(int value) : value{value} { if(value < 0) throw std::invalid_argument("negative"); }
+};
+
+TEST_CASE("shm_variant_queue skips a slot whose constructor threw")
+{
+    const std::string name = "/vocab-types-test-throw-" + std::to_string(getpid());
+    vocab::shm_variant_queue<shm_checked, shm_halt>::unlink(name.c_str());
+    vocab::shm_variant_queue<shm_checked, shm_halt> queue {name.c_str(), 4};
+
+    CHECK_THROWS_AS(queue.try_emplace<shm_checked>(-1), const std::invalid_argument &);
+    int visits = 0;
+    CHECK(!queue.try_receive([&](auto) { ++visits; }));
+    CHECK(visits == 0);
+
+    CHECK_THROWS_AS(queue.try_emplace<shm_checked>(-2), const std::invalid_argument &);
+    CHECK(queue.try_emplace<shm_checked>(5));
+    struct receiver
+    {
+        int received;
+        void operator() (const shm_checked & c) { received = c.value; }
+        void operator() (const shm_halt &) {}
+    } r {0};
+    queue.receive(r);
+    CHECK(r.received == 5);
+
+    // Every slot of the ring remains usable
+    for(int i=0; i<4; ++i) CHECK(queue.try_emplace<shm_halt>(shm_halt{i}));
+    CHECK(!queue.try_emplace<shm_halt>(shm_halt{4}));
+    vocab::shm_variant_queue<shm_checked, shm_halt>::unlink(name.c_str());
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include <sort_variants>
+#include "doctest.h"
+#include <random>
+
+typedef std::variant<int64_t, double, std::string_view> sort_variants_row;
+
+TEST_CASE("sort_variants matches std::sort with variant's operator<")
+{
+    std::vector<std::string> strings;
+    for(int i=0; i<200; ++i) strings.push_back(std::string(i % 7, 'a') + std::to_string(i * 7919 % 503));
+    strings.push_back("");
+
+    std::mt19937 rng {42};
+    std::vector<sort_variants_row> rows;
+    for(int i=0; i<5000; ++i)
+    {
+        switch(rng() % 3)
+        {
+        case 0: rows.push_back(static_cast<int64_t>(rng()) - static_cast<int64_t>(rng()) * 4096); break;
+        case 1: rows.push_back(std::uniform_real_distribution<double>{-1e6, 1e6}(rng)); break;
+        case 2: rows.push_back(std::string_view{strings[rng() % strings.size()]}); break;
+        }
+    }
+    rows.push_back(std::numeric_limits<int64_t>::min());
+    rows.push_back(std::numeric_limits<int64_t>::max());
+    rows.push_back(-std::numeric_limits<double>::infinity());
+
+    auto expected = rows;
+    std::sort(expected.begin(), expected.end());
+    vocab::sort_variants(rows.begin(), rows.end());
+    CHECK(rows == expected);
+}
+
+struct sort_variants_point { int x, y; };
+bool operator < (const sort_variants_point & a, const sort_variants_point & b) { return a.x < b.x; }
+
+TEST_CASE("sort_variants sorts other types stably with their operator<")
+{
+    std::vector<std::variant<sort_variants_point, unsigned char, std::string>> rows {
+        sort_variants_point{2, 0}, std::string{"pear"}, static_cast<unsigned char>(200), sort_variants_point{1, 1},
+        std::string{"apple"}, sort_variants_point{2, 2}, static_cast<unsigned char>(3), sort_variants_point{1, 3}
+    };
+    vocab::sort_variants(rows.begin(), rows.end());
+    REQUIRE(rows.size() == 8);
+    int ys[4];
+    for(int i=0; i<4; ++i) ys[i] = std::get<sort_variants_point>(rows[i]).y;
+    CHECK(ys[0] == 1); CHECK(ys[1] == 3); CHECK(ys[2] == 0); CHECK(ys[3] == 2);
+    CHECK(std::get<unsigned char>(rows[4]) == 3);
+    CHECK(std::get<unsigned char>(rows[5]) == 200);
+    CHECK(std::get<std::string>(rows[6]) == "apple");
+    CHECK(std::get<std::string>(rows[7]) == "pear");
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <sparse_optional_vector>
+#include "doctest.h"
+#include <string>
+#include <vector>
+
+TEST_CASE("sparse_optional_vector holds the same elements as a vector of optionals")
+{
+    vocab::sparse_optional_vector<int> v {1, std::nullopt, 3};
+    REQUIRE(v.size() == 3);
+    CHECK(v.count() == 2);
+    CHECK(v.has_value(0));
+    CHECK(!v.has_value(1));
+    CHECK(v[0].value() == 1);
+    CHECK(!v[1]);
+    CHECK(v[1].value_or(5) == 5);
+    CHECK_THROWS_AS(v[1].value(), const std::bad_optional_access &);
+    CHECK(*v[2] == 3);
+
+    const auto & c = v;
+    CHECK(c[0] == 1);
+    CHECK(c[1] == std::nullopt);
+    CHECK(c[2] == 3);
+
+    std::optional<int> a = v[2], b = v[1];
+    CHECK(a == 3);
+    CHECK(!b);
+    std::optional<int &> r = v[0];
+    *r = 10;
+    CHECK(c[0] == 10);
+
+    std::vector<std::optional<std::string>> dense {std::string{"a"}, std::nullopt, std::nullopt, std::string{"d"}};
+    vocab::sparse_optional_vector<std::string> s(dense.begin(), dense.end());
+    CHECK(s.size() == 4);
+    CHECK(s.count() == 2);
+    CHECK(s[3]->size() == 1);
+    for(size_t i=0; i<dense.size(); ++i) CHECK(std::optional<std::string>(s[i]) == dense[i]);
+}
+
+TEST_CASE("sparse_optional_vector stores only its engaged values")
+{
+    vocab::sparse_optional_vector<int> v;
+    v.push_back(std::nullopt);
+    v.push_back(2);
+    v.push_back(std::optional<int>{});
+    v.push_back(std::optional<int>{4});
+    CHECK(v.count() == 2);
+    CHECK(v.values()[0] == 2);
+    CHECK(v.values()[1] == 4);
+
+    // Engaging and resetting elements in the middle keeps the values in order of index
+    v[0] = 1;
+    v[2] = 3;
+    CHECK(v.count() == 4);
+    for(int i=0; i<4; ++i) CHECK(v.values()[i] == i + 1);
+    v[1] = std::nullopt;
+    v[3].reset();
+    v[3].reset();
+    CHECK(v.count() == 2);
+    CHECK(v.values()[0] == 1);
+    CHECK(v.values()[1] == 3);
+
+    v[0] = 7;
+    CHECK(v.count() == 2);
+    CHECK(v[0].value() == 7);
+    v[1] = v[2];
+    CHECK(v[1].value() == 3);
+    v[2] = v[3];
+    CHECK(!v[2]);
+    CHECK(v.count() == 2);
+
+    v.pop_back();
+    v.pop_back();
+    CHECK(v.size() == 2);
+    CHECK(v.count() == 2);
+    v.pop_back();
+    CHECK(v.count() == 1);
+    v.clear();
+    CHECK(v.empty());
+    CHECK(v.count() == 0);
+}
+
+TEST_CASE("sparse_optional_vector ranks and selects engaged elements across bitmap words")
+{
+    vocab::sparse_optional_vector<size_t> v(1000);
+    CHECK(v.size() == 1000);
+    CHECK(v.count() == 0);
+    CHECK(v.bitmap_words() == 16);
+
+    std::vector<size_t> engaged;
+    for(size_t i=3; i<1000; i+=37) { v[i] = i; engaged.push_back(i); }
+    v[998] = 998;
+    engaged.push_back(998);
+    REQUIRE(v.count() == engaged.size());
+
+    for(size_t k=0; k<engaged.size(); ++k)
+    {
+        CHECK(v.select(k) == engaged[k]);
+        CHECK(v.rank(engaged[k]) == k);
+        CHECK(v[engaged[k]].value() == engaged[k]);
+    }
+    CHECK(v.rank(0) == 0);
+    CHECK(v.rank(4) == 1);
+    CHECK(v.rank(1000) == v.count());
+
+    std::vector<size_t> visited;
+    const auto & c = v;
+    c.for_each_engaged([&](size_t i, const size_t & x) { CHECK(i == x); visited.push_back(i); });
+    CHECK(visited == engaged);
+
+    // Engaging an element in an early word shifts the ranks of every later word
+    v[0] = 0;
+    CHECK(v.rank(engaged.back()) == engaged.size());
+    CHECK(v.select(engaged.size()) == 998);
+    v.for_each_engaged([](size_t i, size_t & x) { x = i * 2; });
+    CHECK(v[998].value() == 1996);
+
+    v.resize(500);
+    CHECK(v.count() == 1 + (500 - 3 + 36) / 37);
+    CHECK(v.bitmap_words() == 8);
+    CHECK((v.bitmap()[7] >> (500 - 448)) == 0);
+    v.resize(1000);
+    CHECK(!v[998]);
+    v.push_back(1000);
+    CHECK(v.select(v.count() - 1) == 1000);
+    CHECK(v.bitmap_words() == 16);
+}
\ No newline at end of file
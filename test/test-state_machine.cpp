@@ -0,0 +1,87 @@
+#include <state_machine>
+#include "doctest.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct sm_idle {};
+struct sm_connecting { int attempts; };
+struct sm_connected { std::string peer; };
+
+struct sm_connect {};
+struct sm_timeout {};
+struct sm_established { std::string peer; };
+struct sm_reset {};
+
+struct sm_transitions
+{
+    std::vector<std::string> log;
+
+    sm_connecting operator() (sm_idle &, const sm_connect &) { return {1}; }
+    std::variant<sm_idle, sm_connecting, sm_connected> operator() (sm_connecting & s, const sm_timeout &) { if(s.attempts < 3) return sm_connecting{s.attempts + 1}; return sm_idle{}; }
+    sm_connected operator() (sm_connecting &, const sm_established & e) { return {e.peer}; }
+    void operator() (sm_connected & s, const sm_connect &) { log.push_back("already connected to " + s.peer); }
+    template<class S> sm_idle operator() (S &, const sm_reset &) { return {}; }
+
+    void on_entry(sm_connected & s) { log.push_back("enter " + s.peer); }
+    void on_exit(sm_connected & s) { log.push_back("exit " + s.peer); }
+    void on_entry(sm_idle &) { log.push_back("enter idle"); }
+};
+
+typedef vocab::state_machine<std::variant<sm_idle, sm_connecting, sm_connected>, std::variant<sm_connect, sm_timeout, sm_established, sm_reset>, sm_transitions> sm_connection;
+
+TEST_CASE("state_machine dispatches through its transition table")
+{
+    sm_connection m;
+    CHECK(m.is_in<sm_idle>());
+    CHECK(!m.process(sm_timeout{}));
+    CHECK(m.process(sm_connect{}));
+    REQUIRE(m.is_in<sm_connecting>());
+
+    CHECK(m.process(sm_timeout{}));
+    CHECK(std::get<sm_connecting>(m.state()).attempts == 2);
+    CHECK(m.process(std::variant<sm_connect, sm_timeout, sm_established, sm_reset>{sm_established{"example.org"}}));
+    REQUIRE(m.is_in<sm_connected>());
+    CHECK(std::get<sm_connected>(m.state()).peer == "example.org");
+
+    CHECK(m.process(sm_connect{}));
+    CHECK(m.is_in<sm_connected>());
+    CHECK(m.process(sm_reset{}));
+    CHECK(m.is_in<sm_idle>());
+
+    CHECK((m.transitions().log == std::vector<std::string>{"enter idle", "enter example.org", "already connected to example.org", "exit example.org", "enter idle"}));
+}
+
+TEST_CASE("state_machine transitions to states chosen at run time")
+{
+    sm_connection m {sm_connecting{3}};
+    CHECK(m.process(sm_timeout{}));
+    CHECK(m.is_in<sm_idle>());
+    CHECK((m.transitions().log == std::vector<std::string>{"enter idle"}));
+}
+
+struct sm_fragile
+{
+    sm_fragile() = default;
+    sm_fragile(sm_fragile &&) { throw std::runtime_error("cannot move"); }
+};
+struct sm_fragile_transitions
+{
+    sm_fragile operator() (sm_idle &, const sm_connect &) { return {}; }
+};
+
+TEST_CASE("state_machine refuses to dispatch from a valueless state")
+{
+    vocab::state_machine<std::variant<sm_idle, sm_fragile>, std::variant<sm_connect, sm_reset>, sm_fragile_transitions> m;
+    CHECK_THROWS_AS(m.process(sm_connect{}), const std::runtime_error &);
+    REQUIRE(m.state().valueless_by_exception());
+    CHECK(!m.is_in<sm_idle>());
+    CHECK_THROWS_AS(m.process(sm_connect{}), const std::bad_variant_access &);
+    CHECK_THROWS_AS(m.process(std::variant<sm_connect, sm_reset>{sm_reset{}}), const std::bad_variant_access &);
+
+    std::variant<sm_connect, sm_reset> event;
+    CHECK_THROWS_AS(event.emplace_from<sm_reset>([]() -> sm_reset { throw std::runtime_error("unavailable"); }), const std::runtime_error &);
+    vocab::state_machine<std::variant<sm_idle, sm_fragile>, std::variant<sm_connect, sm_reset>, sm_fragile_transitions> n;
+    CHECK_THROWS_AS(n.process(event), const std::bad_variant_access &);
+    CHECK(n.is_in<sm_idle>());
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include <tag_column>
+#include "doctest.h"
+#include <stdexcept>
+#include <string>
+
+typedef std::variant<int, double, std::string> tag_column_event;
+
+TEST_CASE("tag_column encodes runs of variant indices")
+{
+    CHECK((vocab::tag_column<std::variant<int>>::tag_bits == 1));
+    CHECK((vocab::tag_column<std::variant<int, double>>::tag_bits == 1));
+    CHECK((vocab::tag_column<tag_column_event>::tag_bits == 2));
+    CHECK((vocab::tag_column<std::variant<char, short, int, long, float>>::tag_bits == 3));
+
+    std::vector<tag_column_event> events {1, 2, 3, 1.5, 2.5, std::string{"a"}, 4, 5};
+    vocab::tag_column<tag_column_event> tags {events.begin(), events.end()};
+    REQUIRE(tags.size() == events.size());
+    CHECK(tags.run_count() == 4);
+    for(size_t i=0; i<events.size(); ++i) CHECK(tags[i] == events[i].index());
+
+    unsigned char decoded[6];
+    tags.decode(2, 6, decoded);
+    for(size_t i=0; i<6; ++i) CHECK(decoded[i] == events[i + 2].index());
+
+    std::vector<size_t> run_tags, run_lengths;
+    for(auto r : tags.runs()) { run_tags.push_back(r.tag); run_lengths.push_back(r.end - r.begin); }
+    CHECK((run_tags == std::vector<size_t>{0, 1, 2, 0}));
+    CHECK((run_lengths == std::vector<size_t>{3, 2, 1, 2}));
+}
+
+TEST_CASE("tag_column uses under one bit per element for repetitive columns")
+{
+    std::vector<tag_column_event> events;
+    for(int i=0; i<100000; ++i) if(i / 1000 % 2) events.push_back(i * 0.5); else events.push_back(i);
+    vocab::tag_column<tag_column_event> tags {events.begin(), events.end()};
+    tags.shrink_to_fit();
+    CHECK(tags.run_count() == 100);
+    CHECK(tags.memory_usage() * 8 < events.size());
+}
+
+TEST_CASE("visit_runs resolves each run's alternative once")
+{
+    std::vector<tag_column_event> events {1, 2, 3, 1.5, 2.5, std::string{"abc"}, 4};
+    vocab::tag_column<tag_column_event> tags {events.begin(), events.end()};
+    struct totals
+    {
+        int ints = 0; double doubles = 0; size_t chars = 0;
+        void operator() (int x) { ints += x; }
+        void operator() (double x) { doubles += x; }
+        void operator() (const std::string & s) { chars += s.size(); }
+    } t;
+    vocab::visit_runs(tags, events.begin(), t);
+    CHECK(t.ints == 10);
+    CHECK(t.doubles == 4.0);
+    CHECK(t.chars == 3);
+}
+
+TEST_CASE("tag_column rejects a valueless variant")
+{
+    std::vector<tag_column_event> events {1, 2.5};
+    CHECK_THROWS_AS(events[1].emplace_from<int>([]() -> int { throw std::runtime_error("unavailable"); }), const std::runtime_error &);
+    REQUIRE(events[1].valueless_by_exception());
+    CHECK_THROWS_AS((vocab::tag_column<tag_column_event>{events.begin(), events.end()}), const std::bad_variant_access &);
+
+    vocab::tag_column<tag_column_event> tags;
+    tags.push_back(0);
+    CHECK_THROWS_AS(tags.push_back(std::variant_npos), const std::bad_variant_access &);
+    CHECK(tags.size() == 1);
+    CHECK(tags.run_count() == 1);
+}
\ No newline at end of file
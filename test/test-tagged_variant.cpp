@@ -0,0 +1,63 @@
+#include <tagged_variant>
+#include "doctest.h"
+#include <string>
+
+struct tv_ping { int seq; tv_ping(int seq = 0) : seq{seq} {} bool operator == (const tv_ping & r) const { return seq == r.seq; } bool operator != (const tv_ping & r) const { return seq != r.seq; } };
+struct tv_data { std::string payload; tv_data(int n = 0) : payload(static_cast<size_t>(n), 'd') {} bool operator == (const tv_data & r) const { return payload == r.payload; } bool operator != (const tv_data & r) const { return payload != r.payload; } };
+struct tv_close { int code; tv_close(int code = 0) : code{code} {} bool operator == (const tv_close & r) const { return code == r.code; } bool operator != (const tv_close & r) const { return code != r.code; } };
+
+typedef vocab::tagged_variant<vocab::tag_v<0x10, tv_ping>, vocab::tag_v<0x22, tv_data>, vocab::tag_v<0x7F, tv_close>> tv_message;
+typedef vocab::tagged_variant<vocab::tag_v<0x10, tv_ping>, vocab::tag_v<0x10000, tv_close>> tv_sparse_message;
+
+struct tv_describe
+{
+    std::string operator() (const tv_ping & m) const { return "ping " + std::to_string(m.seq); }
+    std::string operator() (const tv_data & m) const { return "data " + m.payload; }
+    std::string operator() (const tv_close & m) const { return "close " + std::to_string(m.code); }
+};
+
+TEST_CASE("tagged_variant index() is the wire tag")
+{
+    tv_message m;
+    CHECK(m.index() == 0x10);
+    CHECK(m.position() == 0);
+
+    m = tv_close{3};
+    CHECK(m.index() == 0x7F);
+    CHECK(vocab::holds_tag<0x7F>(m));
+    CHECK(vocab::get<0x7F>(m).code == 3);
+    CHECK(vocab::get_if<0x22>(&m) == nullptr);
+    CHECK_THROWS_AS(vocab::get<0x10>(m), const std::bad_variant_access &);
+
+    m.emplace<0x22>(4);
+    CHECK(m.index() == 0x22);
+    CHECK(vocab::visit(tv_describe{}, m) == "data dddd");
+    m.emplace<tv_ping>(9);
+    CHECK(vocab::visit(tv_describe{}, m) == "ping 9");
+    CHECK(m == tv_message{tv_ping{9}});
+    CHECK(m != tv_message{tv_ping{8}});
+}
+
+TEST_CASE("tagged_variant decodes run-time tags through a table")
+{
+    CHECK(tv_message::position_of(0x10) == 0);
+    CHECK(tv_message::position_of(0x22) == 1);
+    CHECK(tv_message::position_of(0x7F) == 2);
+    CHECK(tv_message::position_of(0x23) == tv_message::alternative_count);
+    CHECK(tv_message::position_of(0x12345) == tv_message::alternative_count);
+    CHECK(tv_message::tag_at(1) == 0x22);
+
+    tv_message m;
+    CHECK(m.emplace_tag(0x7F, 5));
+    CHECK(vocab::visit(tv_describe{}, m) == "close 5");
+    CHECK(m.emplace_tag(0x22, 2));
+    CHECK(vocab::visit(tv_describe{}, m) == "data dd");
+    CHECK(!m.emplace_tag(0x11, 1));
+    CHECK(m.index() == 0x22);
+
+    tv_sparse_message s;
+    CHECK(tv_sparse_message::position_of(0x10000) == 1);
+    CHECK(tv_sparse_message::position_of(0x10001) == 2);
+    CHECK(s.emplace_tag(0x10000, 7));
+    CHECK(vocab::get<0x10000>(s).code == 7);
+}
\ No newline at end of file
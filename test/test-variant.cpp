@@ -1,5 +1,6 @@
 #include <variant>
 #include "doctest.h"
+#include "test-payload.h"
 #include <typeinfo>
 #include <sstream>
 #include <vector>
@@ -216,4 +217,22 @@ TEST_CASE("optional can be used as key type in unordered containers")
 {
     std::unordered_set<std::variant<int, bool, double, std::string>> a {12, std::string{"Hello"}, false, 3.5, std::string{"world!"}, true, 45, 7.7};
     std::unordered_multiset<std::variant<int, bool, double, std::string>> b {12, std::string{"Hello"}, false, 3.5, std::string{"Hello"}, true, 12, 7.7};
+}
+
+TEST_CASE("variant emplace_from constructs from a factory result in place")
+{
+    test_big_payload::copies_and_moves() = 0;
+    std::variant<int, test_big_payload> v {std::in_place<1>, std::in_place_from, []() { return test_big_payload{'a'}; }};
+    CHECK(v.index() == 1);
+    CHECK(std::get<1>(v).bytes[4095] == 'a');
+
+    v = 5;
+    auto & p = v.emplace_from<test_big_payload>([]() { return test_big_payload{'b'}; });
+    CHECK(v.index() == 1);
+    CHECK(&p == &std::get<1>(v));
+    CHECK(p.bytes[0] == 'b');
+    CHECK(test_big_payload::copies_and_moves() == 0);
+
+    CHECK(v.emplace_from<0>([]() { return 42; }) == 42);
+    CHECK(std::get<0>(v) == 42);
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include <variant_channel>
+#include "doctest.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+struct channel_msg_a { int value; };
+struct channel_msg_b
+{
+    static int moves;
+    std::string text;
+    channel_msg_b(std::string text) : text{move(text)} {}
+    channel_msg_b(const channel_msg_b & r) : text{r.text} { ++moves; }
+    channel_msg_b(channel_msg_b && r) : text{move(r.text)} { ++moves; }
+};
+int channel_msg_b::moves = 0;
+
+struct channel_throws { channel_throws(int) { throw std::runtime_error("construction failed"); } };
+
+TEST_CASE("variant_channel constructs and visits messages in place")
+{
+    vocab::variant_channel<channel_msg_a, channel_msg_b> ch {3};
+    CHECK(ch.capacity() == 4);
+
+    channel_msg_b::moves = 0;
+    CHECK(ch.try_emplace<channel_msg_a>(channel_msg_a{1}));
+    CHECK(ch.try_emplace<channel_msg_b>("two"));
+    CHECK(ch.try_emplace<0>(channel_msg_a{3}));
+    CHECK(ch.try_push(std::variant<channel_msg_a, channel_msg_b>{channel_msg_a{4}}));
+    CHECK(!ch.try_emplace<channel_msg_a>(channel_msg_a{5}));
+
+    struct recorder
+    {
+        std::vector<std::string> & log;
+        void operator() (const channel_msg_a & a) const { log.push_back(std::to_string(a.value)); }
+        void operator() (const channel_msg_b & b) const { log.push_back(b.text); }
+    };
+    std::vector<std::string> log;
+    CHECK(ch.try_receive(recorder{log}));
+    CHECK(ch.try_receive_batch(recorder{log}, 8) == 3);
+    CHECK(!ch.try_receive(recorder{log}));
+    CHECK((log == std::vector<std::string>{"1", "two", "3", "4"}));
+    CHECK(channel_msg_b::moves == 0);
+}
+
+TEST_CASE("variant_channel skips messages whose construction threw")
+{
+    vocab::variant_channel<int, channel_throws> ch {4};
+    ch.emplace<int>(1);
+    CHECK_THROWS_AS(ch.try_emplace<channel_throws>(0), const std::runtime_error &);
+    ch.emplace<int>(2);
+    int sum = 0;
+    auto add = [&](const auto & x) { sum += sizeof(x) == sizeof(int) ? 1 : 100; };
+    CHECK(ch.try_receive_batch(add, 4) == 3);
+    CHECK(sum == 2);
+
+    // A single receive skips the empty slot and visits the message after it
+    CHECK_THROWS_AS(ch.try_emplace<channel_throws>(0), const std::runtime_error &);
+    ch.emplace<int>(3);
+    int visits = 0;
+    CHECK(ch.try_receive([&](const auto &) { ++visits; }));
+    CHECK(visits == 1);
+    CHECK_THROWS_AS(ch.try_emplace<channel_throws>(0), const std::runtime_error &);
+    CHECK(!ch.try_receive([&](const auto &) { ++visits; }));
+    ch.emplace<int>(4);
+    ch.receive([&](const auto &) { ++visits; });
+    CHECK(visits == 2);
+}
+
+TEST_CASE("variant_channel delivers every message with multiple producers and consumers")
+{
+    vocab::variant_channel<int, long long> ch {64};
+    std::atomic<long long> total {0};
+    std::atomic<int> received {0};
+    std::vector<std::thread> threads;
+    for(int p=0; p<3; ++p) threads.emplace_back([&ch, p]() { for(int i=1; i<=1000; ++i) if(i % 2) ch.emplace<int>(i); else ch.emplace<long long>(i); });
+    for(int c=0; c<3; ++c) threads.emplace_back([&]()
+    {
+        auto add = [&](auto x) { total += x; ++received; };
+        while(received < 3000) if(!ch.try_receive_batch(add, 16)) std::this_thread::yield();
+    });
+    for(auto & t : threads) t.join();
+    CHECK(received == 3000);
+    CHECK(total == 3 * 500500);
+}
\ No newline at end of file